@@ -7,11 +7,34 @@ namespace DX9OverlayAPI
     {
         public const String PATH = "dx9_overlay.dll";
 
+        public const int EventFrameStats = 1 << 0;
+        public const int EventResolutionChanged = 1 << 1;
+        public const int EventDeviceReset = 1 << 2;
+        public const int EventLoadFailed = 1 << 3;
+
+        public const int PropertyShown = 1;
+        public const int PropertyX = 2;
+        public const int PropertyY = 3;
+        public const int PropertyX2 = 4;
+        public const int PropertyY2 = 5;
+        public const int PropertyWidth = 6;
+        public const int PropertyHeight = 7;
+        public const int PropertyColor = 8;
+        public const int PropertyBorderShown = 9;
+        public const int PropertyBorderWidth = 10;
+        public const int PropertyBorderColor = 11;
+        public const int PropertyShadow = 12;
+        public const int PropertyRotation = 13;
+        public const int PropertyAlign = 14;
+        public const int PropertyPriority = 15;
+
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int TextCreate(string font, int fontSize, bool bBold, bool bItalic, int x, int y, uint color, string text, bool bShadow, bool bShow);
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Unicode)]
         public static extern int TextCreateUnicode(string font, int fontSize, bool bBold, bool bItalic, int x, int y, uint color, string text, bool bShadow, bool bShow);
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int TextCreateAsync(string font, int fontSize, bool bBold, bool bItalic, int x, int y, uint color, string text, bool bShadow, bool bShow);
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int TextDestroy(int id);
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int TextSetShadow(int id, bool b);
@@ -33,6 +56,8 @@ namespace DX9OverlayAPI
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int BoxCreate(int x, int y, int w, int h, uint dwColor, bool bShow);
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int BoxCreateAsync(int x, int y, int w, int h, uint dwColor, bool bShow);
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int BoxDestroy(int id);
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int BoxSetShown(int id, bool bShown);
@@ -52,6 +77,8 @@ namespace DX9OverlayAPI
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int LineCreate(int x1, int y1, int x2, int y2, int width, uint color, bool bShow);
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int LineCreateAsync(int x1, int y1, int x2, int y2, int width, uint color, bool bShow);
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int LineDestroy(int id);
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int LineSetShown(int id, bool bShown);
@@ -65,6 +92,8 @@ namespace DX9OverlayAPI
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int ImageCreate(string path, int x, int y, int rotation, int align, bool bShow);
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int ImageCreateAsync(string path, int x, int y, int rotation, int align, bool bShow);
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int ImageDestroy(int id);
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int ImageSetShown(int id, bool bShown);
@@ -85,6 +114,8 @@ namespace DX9OverlayAPI
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int GetFrameRate();
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetCoalescedUpdates();
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int GetScreenSpecs(out int width, out int height);
 
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
@@ -93,6 +124,29 @@ namespace DX9OverlayAPI
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int SetOverlayPriority(int id, int priority);
 
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int OverlayBulkUpdate(int[] records, int count);
+
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int OverlaySync();
+
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int OverlayBatchBegin();
+
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int OverlayBatchCommit();
+
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int OverlayAwait(int ticket);
+
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int OverlaySubscribe(int events);
+
+        [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int OverlayNextEvent(out int eventId, out int value1, out int value2, int timeout);
+
+        // 1 on success, 0 if the game or the server couldn't be reached, -1 if the game runs the
+        // server of another dx9_overlay.dll version
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
         public static extern int Init();
         [DllImport(PATH, CallingConvention = CallingConvention.Cdecl)]
@@ -1,8 +1,38 @@
 #pragma once
 #define IMPORT extern "C" __declspec(dllimport)
 
+// Events for OverlaySubscribe, the values OverlayNextEvent returns are listed behind them
+enum OverlayEvent
+{
+	EventFrameStats = 1 << 0,			// frames per second, frame time in microseconds
+	EventResolutionChanged = 1 << 1,	// width, height
+	EventDeviceReset = 1 << 2,
+	EventLoadFailed = 1 << 3			// object id
+};
+
+// Properties for OverlayBulkUpdate, every record is { object id, property, value }
+enum OverlayProperty
+{
+	PropertyShown = 1,
+	PropertyX,
+	PropertyY,
+	PropertyX2,
+	PropertyY2,
+	PropertyWidth,
+	PropertyHeight,
+	PropertyColor,
+	PropertyBorderShown,
+	PropertyBorderWidth,
+	PropertyBorderColor,
+	PropertyShadow,
+	PropertyRotation,
+	PropertyAlign,
+	PropertyPriority
+};
+
 IMPORT int TextCreate(const char *Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, const char *text, bool bShadow, bool bShow);
 IMPORT int TextCreateUnicode(const wchar_t *Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, const wchar_t *text, bool bShadow, bool bShow);
+IMPORT int TextCreateAsync(const char *Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, const char *text, bool bShadow, bool bShow);
 IMPORT int TextDestroy(int ID);
 IMPORT int TextSetShadow(int id, bool b);
 IMPORT int TextSetShown(int id, bool b);
@@ -14,6 +44,7 @@ IMPORT int TextUpdate(int id, const char *Font, int FontSize, bool bBold, bool b
 IMPORT int TextUpdateUnicode(int id, const wchar_t *Font, int FontSize, bool bBold, bool bItalic);
 
 IMPORT int BoxCreate(int x, int y, int w, int h, unsigned int dwColor, bool bShow);
+IMPORT int BoxCreateAsync(int x, int y, int w, int h, unsigned int dwColor, bool bShow);
 IMPORT int BoxDestroy(int id);
 IMPORT int BoxSetShown(int id, bool bShown);
 IMPORT int BoxSetBorder(int id, int height, bool bShown);
@@ -24,6 +55,7 @@ IMPORT int BoxSetPos(int id, int x, int y);
 IMPORT int BoxSetWidth(int id, int width);
 
 IMPORT int LineCreate(int x1, int y1, int x2, int y2, int width, unsigned int color, bool bShow);
+IMPORT int LineCreateAsync(int x1, int y1, int x2, int y2, int width, unsigned int color, bool bShow);
 IMPORT int LineDestroy(int id);
 IMPORT int LineSetShown(int id, bool bShown);
 IMPORT int LineSetColor(int id, unsigned int color);
@@ -31,6 +63,7 @@ IMPORT int LineSetWidth(int id, int width);
 IMPORT int LineSetPos(int id, int x1, int y1, int x2, int y2);
 
 IMPORT int ImageCreate(const char *path, int x, int y, int rotation, int align, bool bShow);
+IMPORT int ImageCreateAsync(const char *path, int x, int y, int rotation, int align, bool bShow);
 IMPORT int ImageDestroy(int id);
 IMPORT int ImageSetShown(int id, bool bShown);
 IMPORT int ImageSetAlign(int id, int align);
@@ -42,11 +75,22 @@ IMPORT int ShowAllVisual();
 IMPORT int HideAllVisual();
 
 IMPORT int GetFrameRate();
+IMPORT int GetCoalescedUpdates();
 IMPORT int GetScreenSpecs(int& width, int& height);
 
 IMPORT int SetCalculationRatio(int width, int height);
 
 IMPORT int SetOverlayPriority(int id, int priority);
+IMPORT int OverlayBulkUpdate(const int *records, int count);
+
+IMPORT int OverlaySync();
+IMPORT int OverlayBatchBegin();
+IMPORT int OverlayBatchCommit();
+IMPORT int OverlayAwait(int ticket);
+IMPORT int OverlaySubscribe(int events);
+IMPORT int OverlayNextEvent(int& event, int& value1, int& value2, int timeout);
 
+// 1 on success, 0 if the game or the server couldn't be reached, -1 if the game runs the
+// server of another dx9_overlay.dll version
 IMPORT int  Init();
 IMPORT void SetParam(const char *_szParamName, const char *_szParamValue);
@@ -1,14 +1,26 @@
 #include "Client.h"
+#include "Request.h"
 
 #include <dllmain.h>
 #include <ShlObj.h>
 
 #include <Shared/PipeMessages.h>
+#include <Shared/Config.h>
 #include <Utils/Misc.h>
+#include <Utils/SharedMemoryChannel.h>
+#include <Utils/OrderedTransport.h>
 
+#include <algorithm>
 #include <string>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/thread/tss.hpp>
+
+// How long Init() waits for an injected server to accept connections
+#define SERVER_READY_TIMEOUT 10000
 
 struct stParamInfo
 {
@@ -16,20 +28,238 @@ struct stParamInfo
 	std::string szParamValue;
 };
 
-stParamInfo g_paramArray[3] =
+stParamInfo g_paramArray[5] =
 {
 	"process", "",
 	"window", "",
-	"use_window", "0"
+	"use_window", "0",
+	"transport", "pipe",
+	"one_way", "0"
 };
 
+// Cached value of the "one_way" parameter, checked by every setter
+bool g_bOneWay = false;
+
+ServerInfo g_serverInfo = { 0 };
+
+// Cleared by any failed transaction, the next SERVER_CHECK starts a new session
+std::atomic<bool> g_bHandshakeDone(false);
+
+// Set if the last handshake reached a server of another PROTOCOL_VERSION
+std::atomic<bool> g_bVersionMismatch(false);
+
+// Handles are only valid for the server they were received from
+std::unordered_map<std::string, int> g_stringHandles;
+std::mutex g_stringHandlesMutex;
+
+// Optional transport, used instead of the pipe once SetParam("transport", "shared_memory") was set
+SharedMemoryChannel g_sharedMemory;
+std::mutex g_sharedMemoryMutex;
+
+PipeTransport g_pipe;
+
+// Messages which don't fit into the shared memory channel go through the pipe, in the order they were sent
+OrderedTransport g_sharedMemoryOrPipe(g_sharedMemory, []()
+{
+	return g_sharedMemory.isOpen() ? g_sharedMemory.maxMessageSize() : 0;
+}, g_sharedMemoryMutex, g_pipe);
+
+// Replaces the pipe and the shared memory channel once it was set with SetTransport()
+Transport *g_pTransport = nullptr;
+
+// Never deleted, joining its reader thread while the DLL is unloaded would deadlock on the loader lock
+AsyncPipeClient *g_pAsyncPipe = new AsyncPipeClient();
+
+// Never deleted for the same reason
+EventClient *g_pEventClient = new EventClient();
+
+// Replies of asynchronous creates until OverlayAwait() collects them
+std::unordered_map<int, std::future<int> > g_tickets;
+std::mutex g_ticketsMutex;
+int g_lastTicket = 0;
+
+// Kept for the whole thread, so the buffer is reused by the next batch
+boost::thread_specific_ptr<CommandBatch> g_batch;
+
+void ResetStringHandles()
+{
+	std::lock_guard<std::mutex> lock(g_stringHandlesMutex);
+	g_stringHandles.clear();
+}
+
+// Gives the handles back to the server of the current session, so its table doesn't keep our strings
+void ReleaseStringHandles()
+{
+	std::unordered_map<std::string, int> handles;
+	{
+		std::lock_guard<std::mutex> lock(g_stringHandlesMutex);
+		handles.swap(g_stringHandles);
+	}
+
+	if (!g_bHandshakeDone)
+		return;
+
+	for (auto& entry : handles)
+		requestOr<PipeMessages::StringRelease>(0, entry.second);
+}
+
+void CloseSharedMemory()
+{
+	std::lock_guard<std::mutex> lock(g_sharedMemoryMutex);
+	g_sharedMemory.close();
+}
+
+void OpenSharedMemory();
+std::string GetParam(char *_szParamName);
+
+// A transport only fails if the server can't be reached, so the session has to be negotiated again
+static bool checkTransport(bool bSuccess)
+{
+	if (!bSuccess)
+		g_bHandshakeDone = false;
+
+	return bSuccess;
+}
+
 bool IsServerAvailable()
 {
-	Serializer serializerIn, serializerOut;
+	// The capabilities are only negotiated once per session, the requests themselves report a lost server
+	if (g_bHandshakeDone)
+		return true;
+
+	ResetStringHandles();
+	CloseSharedMemory();
+
+	// Servers without handshake support answer with an empty reply, which reads as version 0.
+	// A server of another version can't decode any of our messages, so there's no session at all.
+	ServerInfo info = { 0 };
+	bool bReachable = request<PipeMessages::Handshake>(info, PROTOCOL_VERSION);
+
+	g_bVersionMismatch = bReachable && info.protocolVersion != PROTOCOL_VERSION;
+	if (bReachable && !g_bVersionMismatch)
+		g_serverInfo = info;
+
+	g_bHandshakeDone = bReachable && !g_bVersionMismatch;
+
+	if (g_bHandshakeDone)
+		OpenSharedMemory();
+
+	return g_bHandshakeDone;
+}
+
+bool SendRequest(Serializer& serializerIn, Serializer& serializerOut)
+{
+	Transport& transport = g_pTransport ? *g_pTransport : g_sharedMemoryOrPipe;
+	return checkTransport(transport.transact(serializerIn, serializerOut));
+}
+
+bool PostRequest(Serializer& serializerIn)
+{
+	Transport& transport = g_pTransport ? *g_pTransport : g_sharedMemoryOrPipe;
+	return checkTransport(transport.post(serializerIn));
+}
+
+void SendAsyncRequest(Serializer& serializerIn, unsigned int requestId, const AsyncPipeClient::Completion& completion)
+{
+	if (!g_pTransport)
+	{
+		return g_pAsyncPipe->send(serializerIn, requestId, [completion](bool bSuccess, Serializer& serializerOut)
+		{
+			completion(checkTransport(bSuccess), serializerOut);
+		});
+	}
+
+	// Other transports have no pipelining, the request is completed before returning
+	Serializer serializerOut;
+
+	unsigned int replyId = 0;
+	bool bSuccess = checkTransport(g_pTransport->transact(serializerIn, serializerOut));
+	if (bSuccess)
+		serializerOut >> replyId;
+
+	completion(bSuccess, serializerOut);
+}
+
+void SetTransport(Transport *transport)
+{
+	// The capabilities and string handles belong to the previous server
+	ReleaseStringHandles();
+
+	g_pTransport = transport;
+	g_bHandshakeDone = false;
+	CloseSharedMemory();
+}
+
+unsigned int NextRequestId()
+{
+	return g_pAsyncPipe->nextRequestId();
+}
+
+bool IsSessionActive()
+{
+	return g_bHandshakeDone;
+}
+
+int AddTicket(std::future<int> result)
+{
+	std::lock_guard<std::mutex> lock(g_ticketsMutex);
+
+	if (++g_lastTicket <= 0)
+		g_lastTicket = 1;
+
+	g_tickets[g_lastTicket] = std::move(result);
+	return g_lastTicket;
+}
+
+bool IsOneWayEnabled()
+{
+	return g_bOneWay && IsFeatureSupported(FeatureOneWay);
+}
+
+CommandBatch *GetActiveBatch()
+{
+	CommandBatch *batch = g_batch.get();
+	return batch && batch->depth > 0 ? batch : nullptr;
+}
+
+bool IsFeatureSupported(ProtocolFeature feature)
+{
+	return g_bHandshakeDone && (g_serverInfo.features & feature) != 0;
+}
+
+const ServerInfo& GetServerInfo()
+{
+	return g_serverInfo;
+}
+
+int GetStringHandle(boost::string_ref str)
+{
+	if (!IsFeatureSupported(FeatureStringInterning))
+		return 0;
+
+	{
+		std::lock_guard<std::mutex> lock(g_stringHandlesMutex);
 
-	serializerIn << PipeMessages::Ping;
+		auto it = g_stringHandles.find(str.to_string());
+		if (it != g_stringHandles.end())
+			return it->second;
+	}
+
+	int handle = requestOr<PipeMessages::StringIntern>(0, str);
+	if (handle == 0)
+		return 0;
+
+	{
+		std::lock_guard<std::mutex> lock(g_stringHandlesMutex);
 
-	return PipeClient(serializerIn, serializerOut).success();
+		// Another thread has interned it meanwhile, the server counted both references
+		auto result = g_stringHandles.insert(std::make_pair(str.to_string(), handle));
+		if (result.second)
+			return handle;
+	}
+
+	requestOr<PipeMessages::StringRelease>(0, handle);
+	return handle;
 }
 
 EXPORT void SetParam(char *_szParamName, char *_szParamValue)
@@ -38,6 +268,7 @@ EXPORT void SetParam(char *_szParamName, char *_szParamValue)
 	if (boost::iequals(_szParamName, g_paramArray[i].szParamName))
 		g_paramArray[i].szParamValue = _szParamValue;
 
+	g_bOneWay = atoi(GetParam("one_way").c_str()) != 0;
 	return;
 }
 
@@ -50,6 +281,19 @@ std::string GetParam(char *_szParamName)
 	return "";
 }
 
+void OpenSharedMemory()
+{
+	if (!boost::iequals(GetParam("transport"), "shared_memory") || !IsFeatureSupported(FeatureSharedMemory))
+		return;
+
+	int id = requestOr<PipeMessages::OpenSharedMemory>(0, (int) GetCurrentProcessId());
+	if (id == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(g_sharedMemoryMutex);
+	g_sharedMemory.open(SharedMemoryChannel::nameOf(id));
+}
+
 
 EXPORT int Init()
 {
@@ -57,6 +301,13 @@ EXPORT int Init()
 	DWORD dwPId = 0;
 	BOOL bRetn;
 
+	// A (re)injected server starts a new session
+	g_bHandshakeDone = false;
+	ResetStringHandles();
+	CloseSharedMemory();
+	PipeClient::closeConnections();
+	g_pAsyncPipe->close();
+
 	GetModuleFileName((HMODULE) g_hDllHandle, szDLLPath, sizeof(szDLLPath));
 	if (!atoi(GetParam("use_window").c_str()))
 	{
@@ -146,7 +397,120 @@ EXPORT int Init()
 		WaitForSingleObject(hThread, INFINITE);
 		CloseHandle(hThread);
 		CloseHandle(hHandle);
+	}
+
+	// The server signals the event once it accepts connections. It stays set while the server is
+	// running, so a server which had already been injected doesn't cause a wait.
+	{
+		char szReadyEvent[MAX_PATH + 1] = { 0 };
+		sprintf_s(szReadyEvent, g_strReadyEventFormat, dwPId);
+
+		HANDLE hReady = CreateEventA(NULL, TRUE, FALSE, szReadyEvent);
+		if (hReady == NULL)
+			return 0;
+
+		DWORD dwWait = WaitForSingleObject(hReady, SERVER_READY_TIMEOUT);
+		CloseHandle(hReady);
+
+		if (dwWait != WAIT_OBJECT_0)
+			return 0;
+	}
+
+	// The game may still run the server of an older or newer dx9_overlay.dll
+	if (!IsServerAvailable())
+		return g_bVersionMismatch ? INIT_VERSION_MISMATCH : 0;
+
+	return 1;
+}
+
+EXPORT int OverlaySync()
+{
+	SERVER_CHECK(-1)
+
+	return requestOr<PipeMessages::Sync>(-1);
+}
 
+EXPORT int OverlayBatchBegin()
+{
+	SERVER_CHECK(0)
+
+	if (!IsFeatureSupported(FeatureBatching))
+		return 0;
+
+	if (!g_batch.get())
+	{
+		g_batch.reset(new CommandBatch);
+		g_batch->count = 0;
+		g_batch->depth = 0;
+	}
+
+	// Nested batches are sent with the outermost one
+	g_batch->depth++;
+	return 1;
+}
+
+EXPORT int OverlayBatchCommit()
+{
+	CommandBatch *batch = GetActiveBatch();
+	if (!batch)
+		return -1;
+
+	if (--batch->depth > 0 || batch->count == 0)
+		return 0;
+
+	int count = batch->count;
+	batch->count = 0;
+
+	int failed = requestOr<PipeMessages::Batch>(-1, count,
+		boost::string_ref(batch->commands.data(), batch->commands.numberOfBytesUsed()));
+
+	batch->commands.clear();
+	return failed;
+}
+
+EXPORT int OverlaySubscribe(int events)
+{
+	if (events == 0)
+	{
+		g_pEventClient->close();
 		return 1;
 	}
+
+	SERVER_CHECK(0)
+
+	if (!IsFeatureSupported(FeatureEvents))
+		return 0;
+
+	return g_pEventClient->subscribe(events) ? 1 : 0;
+}
+
+EXPORT int OverlayNextEvent(int& event, int& value1, int& value2, int timeout)
+{
+	EventClient::Event next;
+	if (g_pEventClient->next(next, (DWORD) std::max<int>(timeout, 0)))
+	{
+		event = next.event;
+		value1 = next.value1;
+		value2 = next.value2;
+		return 1;
+	}
+
+	return g_pEventClient->isConnected() ? 0 : -1;
+}
+
+EXPORT int OverlayAwait(int ticket)
+{
+	std::future<int> result;
+	{
+		std::lock_guard<std::mutex> lock(g_ticketsMutex);
+
+		auto it = g_tickets.find(ticket);
+		if (it == g_tickets.end())
+			return -1;
+
+		result = std::move(it->second);
+		g_tickets.erase(it);
+	}
+
+	return result.get();
 }
\ No newline at end of file
@@ -2,20 +2,93 @@
 
 #include <Utils/Windows.h>
 #include <Utils/PipeClient.h>
+#include <Utils/AsyncPipeClient.h>
+#include <Utils/EventClient.h>
+#include <Utils/Transport.h>
 #include <Utils/Serializer.h>
+#include <Utils/SerializerPool.h>
+#include <Shared/Protocol.h>
+
+#include <boost/utility/string_ref.hpp>
+
+#include <future>
 
 #define EXPORT extern "C" __declspec(dllexport)
 
-#define SERVER_CHECK(retn)	\
-if (!IsServerAvailable())	\
-{							\
-	if (!Init())			\
-		return retn;		\
-	else					\
-		Sleep(250);			\
-}							\
+// Nothing is sent while the session is active, a lost server is noticed by the failing call.
+// Without a session the server is injected and the call continues once it is ready.
+#define SERVER_CHECK(retn)						\
+if (!IsServerAvailable() && Init() != 1)		\
+	return retn;
 
+// Returned by Init() if the injected server speaks another PROTOCOL_VERSION
+#define INIT_VERSION_MISMATCH	-1
+
+// Negotiates a new session if there's none, true if the server is reachable
 bool IsServerAvailable();
+bool IsFeatureSupported(ProtocolFeature feature);
+const ServerInfo& GetServerInfo();
+
+// Handle of an interned string on the server, 0 if the server can't intern it
+int GetStringHandle(boost::string_ref str);
+
+// Sends an encoded request through the shared memory channel if one is open, otherwise through the pipe
+bool SendRequest(Serializer& serializerIn, Serializer& serializerOut);
+// Sends a one-way request the same way, without waiting for the server
+bool PostRequest(Serializer& serializerIn);
+
+// Routes all requests through 'transport' instead of the pipe and shared memory, e.g. a
+// LoopbackTransport to drive the dispatcher in the same process. nullptr restores the default.
+void SetTransport(Transport *transport);
+
+// Sends a request encoded with encodeTaggedMessage() over the pipelined connection, the
+// completion receives its reply. Always uses the pipe, even if shared memory is enabled.
+void SendAsyncRequest(Serializer& serializerIn, unsigned int requestId, const AsyncPipeClient::Completion& completion);
+unsigned int NextRequestId();
+
+// True once the capabilities have been negotiated. Asynchronous calls only check this,
+// an unreachable server is reported through their reply.
+bool IsSessionActive();
 
+// Keeps the future of an asynchronous create until OverlayAwait() collects it, returns its ticket (> 0)
+int AddTicket(std::future<int> result);
+
+// Set with SetParam("one_way", "1"), only if the server supports it
+bool IsOneWayEnabled();
+
+// Setters called between OverlayBatchBegin() and OverlayBatchCommit(), per thread
+struct CommandBatch
+{
+	Serializer commands;
+	int count;
+	int depth;
+};
+
+// The batch of the calling thread, nullptr if it hasn't begun one
+CommandBatch *GetActiveBatch();
+
+// 1 once the server has been injected and a session negotiated, 0 if the process or the server
+// couldn't be reached, INIT_VERSION_MISMATCH if the game runs a server of another version
 EXPORT int  Init();
-EXPORT void	SetParam(char *_szParamName, char *_szParamValue);
\ No newline at end of file
+EXPORT void	SetParam(char *_szParamName, char *_szParamValue);
+
+// Waits until the server has handled all one-way messages, returns how many of them failed
+EXPORT int	OverlaySync();
+
+// Collects the following setters of the calling thread instead of sending them. Returns 0 if the
+// server doesn't support batches, the setters are sent one by one then.
+EXPORT int	OverlayBatchBegin();
+// Sends the collected setters as one message, the server applies them between two frames.
+// Returns how many of them failed, -1 if the server couldn't be reached.
+EXPORT int	OverlayBatchCommit();
+
+// Starts receiving the events in 'events' (OverlayEvent flags), 0 stops it. Returns 0 if the
+// server doesn't push events, polling OverlayNextEvent() afterwards doesn't cause any traffic.
+EXPORT int	OverlaySubscribe(int events);
+// Waits up to 'timeout' ms for an event the client subscribed to. Returns 1 and its values,
+// 0 if none arrived in time, -1 without subscription or once the server has gone.
+EXPORT int	OverlayNextEvent(int& event, int& value1, int& value2, int timeout);
+
+// Waits for the reply of an asynchronous create (e.g. TextCreateAsync) and returns the id of the
+// created object, or what the synchronous call would have returned on failure. -1 for an unknown ticket.
+EXPORT int	OverlayAwait(int ticket);
\ No newline at end of file
@@ -1,563 +1,395 @@
 #include "Render.h"
+#include "Request.h"
 
 #include <Utils/Misc.h>
-#include <Utils/Serializer.h>
-#include <Utils/PipeClient.h>
+#include <Utils/Utf8.h>
 #include <Utils/Windows.h>
 #include <Shared/PipeMessages.h>
 
 #include <boost/filesystem.hpp>
 
-#define SERIALIZER_RET(T) { T retVal; serializerOut >> retVal; return retVal; }
+#include <climits>
 
-EXPORT int TextCreate(char *Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, char *text, bool bShadow, bool bShow)
+// The ANSI and UTF-16 exports only convert their strings, the wire format is UTF-8
+static int createText(boost::string_ref Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, boost::string_ref text, bool bShadow, bool bShow)
 {
-	SERVER_CHECK(-1)
+	// Font names repeat a lot, send a handle instead once the server knows the name
+	int font = GetStringHandle(Font);
+	if (font != 0)
+		return requestOr<PipeMessages::TextCreateInterned>(-1, font, FontSize, bBold, bItalic, x, y, color, text, bShadow, bShow);
 
-	Serializer serializerIn, serializerOut;
+	return requestOr<PipeMessages::TextCreate>(-1, Font, FontSize, bBold, bItalic, x, y, color, text, bShadow, bShow);
+}
 
-	serializerIn << PipeMessages::TextCreate << std::string(Font) << FontSize << bBold << bItalic << x << y << color << std::string(text);
-	serializerIn << bShadow << bShow;
+static std::future<int> createTextAsync(boost::string_ref Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, boost::string_ref text, bool bShadow, bool bShow)
+{
+	int font = GetStringHandle(Font);
+	if (font != 0)
+		return requestFuture<PipeMessages::TextCreateInterned>(-1, font, FontSize, bBold, bItalic, x, y, color, text, bShadow, bShow);
 
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
+	return requestFuture<PipeMessages::TextCreate>(-1, Font, FontSize, bBold, bItalic, x, y, color, text, bShadow, bShow);
+}
 
-	return -1;
+static int updateText(int id, boost::string_ref Font, int FontSize, bool bBold, bool bItalic)
+{
+	int font = GetStringHandle(Font);
+	if (font != 0)
+		return requestOr<PipeMessages::TextUpdateInterned>(0, id, font, FontSize, bBold, bItalic);
+
+	return requestOr<PipeMessages::TextUpdate>(0, id, Font, FontSize, bBold, bItalic);
 }
 
-EXPORT int TextCreateUnicode(wchar_t *Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, wchar_t *text, bool bShadow, bool bShow)
+EXPORT int TextCreate(char *Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, char *text, bool bShadow, bool bShow)
 {
 	SERVER_CHECK(-1)
 
-	Serializer serializerIn, serializerOut;
+	return createText(Utf8String(Font), FontSize, bBold, bItalic, x, y, color, Utf8String(text), bShadow, bShow);
+}
 
-	serializerIn << PipeMessages::TextCreateUnicode << std::wstring(Font) << FontSize << bBold << bItalic << x << y << color << std::wstring(text);
-	serializerIn << bShadow << bShow;
+EXPORT int TextCreateUnicode(wchar_t *Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, wchar_t *text, bool bShadow, bool bShow)
+{
+	SERVER_CHECK(-1)
 
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
+	return createText(Utf8String(Font), FontSize, bBold, bItalic, x, y, color, Utf8String(text), bShadow, bShow);
+}
+
+EXPORT int TextCreateAsync(char *Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, char *text, bool bShadow, bool bShow)
+{
+	if (!IsSessionActive())
+	{
+		SERVER_CHECK(-1)
+	}
 
-	return -1;
+	return AddTicket(createTextAsync(Utf8String(Font), FontSize, bBold, bItalic, x, y, color, Utf8String(text), bShadow, bShow));
 }
 
 EXPORT int TextDestroy(int Id)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::TextDestroy << Id;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::TextDestroy>(Id);
 }
 
 EXPORT int TextSetShadow(int id, bool b)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::TextSetShadow << id << b;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::TextSetShadow>(id, b);
 }
 
 EXPORT int TextSetShown(int id, bool b)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::TextSetShown << id << b;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::TextSetShown>(id, b);
 }
 
 EXPORT int TextSetColor(int id, unsigned int color)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::TextSetColor << id << color;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::TextSetColor>(id, color);
 }
 
 EXPORT int TextSetPos(int id, int x, int y)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::TextSetPos << id << x << y;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::TextSetPos>(id, x, y);
 }
 
 EXPORT int TextSetString(int id, char *str)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::TextSetString << id << std::string(str);
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::TextSetString>(id, Utf8String(str));
 }
 
 EXPORT int TextSetStringUnicode(int id, wchar_t *str)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::TextSetStringUnicode << id << std::wstring(str);
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::TextSetString>(id, Utf8String(str));
 }
 
 EXPORT int TextUpdate(int id, char *Font, int FontSize, bool bBold, bool bItalic)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::TextUpdate << id << std::string(Font) << FontSize << bBold << bItalic;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return updateText(id, Utf8String(Font), FontSize, bBold, bItalic);
 }
 
 int TextUpdateUnicode(int id, wchar_t * Font, int FontSize, bool bBold, bool bItalic)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::TextUpdateUnicode << id << std::wstring(Font) << FontSize << bBold << bItalic;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return updateText(id, Utf8String(Font), FontSize, bBold, bItalic);
 }
 
 EXPORT int BoxCreate(int x, int y, int w, int h, unsigned int dwColor, bool bShow)
 {
 	SERVER_CHECK(-1)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::BoxCreate << x << y << w << h << dwColor << bShow;
+	return requestOr<PipeMessages::BoxCreate>(-1, x, y, w, h, dwColor, bShow);
+}
 
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
+EXPORT int BoxCreateAsync(int x, int y, int w, int h, unsigned int dwColor, bool bShow)
+{
+	if (!IsSessionActive())
+	{
+		SERVER_CHECK(-1)
+	}
 
-	return -1;
+	return AddTicket(requestFuture<PipeMessages::BoxCreate>(-1, x, y, w, h, dwColor, bShow));
 }
 
 EXPORT int BoxDestroy(int id)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::BoxDestroy << id;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::BoxDestroy>(id);
 }
 
 EXPORT int BoxSetShown(int id, bool bShown)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::BoxSetShown << id << bShown;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::BoxSetShown>(id, bShown);
 }
 
 EXPORT int BoxSetBorder(int id, int height, bool bShown)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::BoxSetBorder << id << height << bShown;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::BoxSetBorder>(id, height, bShown);
 }
 
 EXPORT int BoxSetBorderColor(int id, unsigned int dwColor)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::BoxSetBorderColor << id << dwColor;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::BoxSetBorderColor>(id, dwColor);
 }
 
 EXPORT int BoxSetColor(int id, unsigned int dwColor)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::BoxSetColor << id << dwColor;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::BoxSetColor>(id, dwColor);
 }
 
 EXPORT int BoxSetHeight(int id, int height)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::BoxSetHeight << id << height;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::BoxSetHeight>(id, height);
 }
 
 EXPORT int BoxSetPos(int id, int x, int y)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::BoxSetPos << id << x << y;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::BoxSetPos>(id, x, y);
 }
 
 EXPORT int BoxSetWidth(int id, int width)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::BoxSetWidth << id << width;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::BoxSetWidth>(id, width);
 }
 
 EXPORT int LineCreate(int x1, int y1, int x2, int y2, int width, unsigned int color, bool bShow)
 {
 	SERVER_CHECK(-1)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::LineCreate << x1 << y1 << x2 << y2 << width << color << bShow;
+	return requestOr<PipeMessages::LineCreate>(-1, x1, y1, x2, y2, width, color, bShow);
+}
 
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
+EXPORT int LineCreateAsync(int x1, int y1, int x2, int y2, int width, unsigned int color, bool bShow)
+{
+	if (!IsSessionActive())
+	{
+		SERVER_CHECK(-1)
+	}
 
-	return -1;
+	return AddTicket(requestFuture<PipeMessages::LineCreate>(-1, x1, y1, x2, y2, width, color, bShow));
 }
 
 EXPORT int LineDestroy(int id)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::LineDestroy << id;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::LineDestroy>(id);
 }
 
 EXPORT int LineSetShown(int id, bool bShown)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::LineSetShown << id << bShown;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::LineSetShown>(id, bShown);
 }
 
 EXPORT int LineSetColor(int id, unsigned int color)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::LineSetColor << id << color;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::LineSetColor>(id, color);
 }
 
 EXPORT int LineSetWidth(int id, int width)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::LineSetWidth << id << width;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-	
-	return 0;
+	return setter<PipeMessages::LineSetWidth>(id, width);
 }
 
 EXPORT int LineSetPos(int id, int x1, int y1, int x2, int y2)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::LineSetPos << id << x1 << y1 << x2 << y2;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::LineSetPos>(id, x1, y1, x2, y2);
 }
 
 EXPORT int ImageCreate(char *path, int x, int y, int rotation, int align, bool bShow)
 {
 	SERVER_CHECK(-1)
 
-	Serializer serializerIn, serializerOut;
-
 	std::string abs_path = boost::filesystem::absolute(path).string();
 	if (!boost::filesystem::exists(abs_path))
 		return -2;
 
-	serializerIn << PipeMessages::ImageCreate << abs_path << x << y << rotation << align << bShow;
+	return requestOr<PipeMessages::ImageCreate>(-1, Utf8String(abs_path.c_str()), x, y, rotation, align, bShow);
+}
 
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
+EXPORT int ImageCreateAsync(char *path, int x, int y, int rotation, int align, bool bShow)
+{
+	if (!IsSessionActive())
+	{
+		SERVER_CHECK(-1)
+	}
+
+	std::string abs_path = boost::filesystem::absolute(path).string();
+	if (!boost::filesystem::exists(abs_path))
+		return -2;
 
-	return -1;
+	return AddTicket(requestFuture<PipeMessages::ImageCreate>(-1, Utf8String(abs_path.c_str()), x, y, rotation, align, bShow));
 }
 
 EXPORT int ImageDestroy(int id)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::ImageDestroy << id;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-	
-	return 0;
+	return setter<PipeMessages::ImageDestroy>(id);
 }
 
 EXPORT int ImageSetShown(int id, bool bShown)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::ImageSetShown << id << bShown;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::ImageSetShown>(id, bShown);
 }
 
 EXPORT int ImageSetAlign(int id, int align)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::ImageSetAlign << id << align;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::ImageSetAlign>(id, align);
 }
 
 EXPORT int ImageSetPos(int id, int x, int y)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::ImageSetPos << id << x << y;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-
-	return 0;
+	return setter<PipeMessages::ImageSetPos>(id, x, y);
 }
 
 EXPORT int ImageSetRotation(int id, int rotation)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::ImageSetRotation << id << rotation;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
-	
-	return 0;
+	return setter<PipeMessages::ImageSetRotation>(id, rotation);
 }
 
 EXPORT int DestroyAllVisual()
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::DestroyAllVisual;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		return 1;
-
-	return 0;
+	return (int) transact<PipeMessages::DestroyAllVisual>();
 }
 
 EXPORT int ShowAllVisual()
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::ShowAllVisual;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		return 1;
-
-	return 0;
+	return (int) transact<PipeMessages::ShowAllVisual>();
 }
 
 EXPORT int HideAllVisual()
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::HideAllVisual;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-		return 1;
-
-	return 0;
+	return (int) transact<PipeMessages::HideAllVisual>();
 }
 
 EXPORT int GetFrameRate()
 {
 	SERVER_CHECK(-1)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::GetFrameRate;
+	return requestOr<PipeMessages::GetFrameRate>(-1);
+}
 
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
+EXPORT int GetCoalescedUpdates()
+{
+	SERVER_CHECK(-1)
 
-	return -1;
+	return requestOr<PipeMessages::GetCoalescedUpdates>(-1);
 }
 
 EXPORT int GetScreenSpecs(int& width, int& height)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::GetScreenSpecs;
-
-	if (PipeClient(serializerIn, serializerOut).success())
-	{
-		serializerOut >> width >> height;
-		return 1;
-	}
+	ScreenSpecs specs;
+	if (!request<PipeMessages::GetScreenSpecs>(specs))
+		return 0;
 
-	return 0;
+	width = specs.first;
+	height = specs.second;
+	return 1;
 }
 
 EXPORT int SetCalculationRatio(int width, int height)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
-
-	serializerIn << PipeMessages::SetCalculationRatio << width << height;
-
-	return (int)PipeClient(serializerIn, serializerOut).success();
+	return (int) transact<PipeMessages::SetCalculationRatio>(width, height);
 }
 
 EXPORT int SetOverlayPriority(int id, int priority)
 {
 	SERVER_CHECK(0)
 
-	Serializer serializerIn, serializerOut;
+	return setter<PipeMessages::SetOverlayPriority>(id, priority);
+}
+
+EXPORT int OverlayBulkUpdate(const int *records, int count)
+{
+	SERVER_CHECK(-1)
+
+	if (!IsFeatureSupported(FeatureBulkUpdate))
+		return -1;
+
+	if (count <= 0)
+		return 0;
 
-	serializerIn << PipeMessages::SetOverlayPriority << id << priority;
+	// Three ints per record
+	if (records == nullptr || count > INT_MAX / 3)
+		return -1;
 
-	if (PipeClient(serializerIn, serializerOut).success())
-		SERIALIZER_RET(int);
+	Serializer encoded;
+	for (int i = 0; i < count * 3; i++)
+		encoded << records[i];
 
-	return 0;
+	return requestOr<PipeMessages::BulkUpdate>(-1, count, boost::string_ref(encoded.data(), encoded.numberOfBytesUsed()));
 }
\ No newline at end of file
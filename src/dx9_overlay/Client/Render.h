@@ -3,6 +3,7 @@
 
 EXPORT int TextCreate(char *Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, char *text, bool bShadow, bool bShow);
 EXPORT int TextCreateUnicode(wchar_t *Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, wchar_t *text, bool bShadow, bool bShow);
+EXPORT int TextCreateAsync(char *Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, char *text, bool bShadow, bool bShow);
 EXPORT int TextDestroy(int ID);
 EXPORT int TextSetShadow(int id, bool b);
 EXPORT int TextSetShown(int id, bool b);
@@ -14,6 +15,7 @@ EXPORT int TextUpdate(int id, char *Font, int FontSize, bool bBold, bool bItalic
 EXPORT int TextUpdateUnicode(int id, wchar_t *Font, int FontSize, bool bBold, bool bItalic);
 
 EXPORT int BoxCreate(int x, int y, int w, int h, unsigned int dwColor, bool bShow);
+EXPORT int BoxCreateAsync(int x, int y, int w, int h, unsigned int dwColor, bool bShow);
 EXPORT int BoxDestroy(int id);
 EXPORT int BoxSetShown(int id, bool bShown);
 EXPORT int BoxSetBorder(int id, int height, bool bShown);
@@ -24,6 +26,7 @@ EXPORT int BoxSetPos(int id, int x, int y);
 EXPORT int BoxSetWidth(int id, int width);
 
 EXPORT int LineCreate(int x1, int y1, int x2, int y2, int width, unsigned int color, bool bShow);
+EXPORT int LineCreateAsync(int x1, int y1, int x2, int y2, int width, unsigned int color, bool bShow);
 EXPORT int LineDestroy(int id);
 EXPORT int LineSetShown(int id, bool bShown);
 EXPORT int LineSetColor(int id, unsigned int color);
@@ -31,6 +34,7 @@ EXPORT int LineSetWidth(int id, int width);
 EXPORT int LineSetPos(int id, int x1, int y1, int x2, int y2);
 
 EXPORT int ImageCreate(char *path, int x, int y, int rotation, int align, bool bShow);
+EXPORT int ImageCreateAsync(char *path, int x, int y, int rotation, int align, bool bShow);
 EXPORT int ImageDestroy(int id);
 EXPORT int ImageSetShown(int id, bool bShown);
 EXPORT int ImageSetAlign(int id, int align);
@@ -42,7 +46,14 @@ EXPORT int ShowAllVisual();
 EXPORT int HideAllVisual();
 
 EXPORT int GetFrameRate();
+// Number of setters the server skipped because a later one changed the same property before the next frame
+EXPORT int GetCoalescedUpdates();
 EXPORT int GetScreenSpecs(int& width, int& height);
 
 EXPORT int SetCalculationRatio(int width, int height);
-EXPORT int SetOverlayPriority(int id, int priority);
\ No newline at end of file
+EXPORT int SetOverlayPriority(int id, int priority);
+
+// Sets many properties of many objects with one message. 'records' holds 'count' records of three
+// ints: object id, OverlayProperty, value. Returns how many records failed, -1 if the server
+// couldn't be reached or doesn't support it.
+EXPORT int OverlayBulkUpdate(const int *records, int count);
\ No newline at end of file
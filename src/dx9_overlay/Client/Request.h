@@ -0,0 +1,119 @@
+#pragma once
+#include "Client.h"
+
+#include <Utils/PipeClient.h>
+#include <Utils/Serializer.h>
+#include <Utils/SerializerPool.h>
+#include <Shared/MessageSchema.h>
+
+#include <future>
+#include <memory>
+
+// Encodes M with the given arguments, sends it to the server and decodes the reply
+template<PipeMessages M, typename ...A>
+bool request(typename MessageSchema<M>::Reply& reply, A&&... args)
+{
+	POOLED_SERIALIZERS(serializerIn, serializerOut)
+
+	encodeMessage<M>(serializerIn, std::forward<A>(args)...);
+
+	if (!SendRequest(serializerIn, serializerOut))
+		return false;
+
+	serializerOut >> reply;
+	return true;
+}
+
+// Like request(), but returns the reply or 'failValue' if the server couldn't be reached
+template<PipeMessages M, typename ...A>
+typename MessageSchema<M>::Reply requestOr(typename MessageSchema<M>::Reply failValue, A&&... args)
+{
+	typename MessageSchema<M>::Reply reply;
+	if (!request<M>(reply, std::forward<A>(args)...))
+		return failValue;
+
+	return reply;
+}
+
+// Sends M and only reports whether the server has answered, the reply is ignored
+template<PipeMessages M, typename ...A>
+bool transact(A&&... args)
+{
+	POOLED_SERIALIZERS(serializerIn, serializerOut)
+
+	encodeMessage<M>(serializerIn, std::forward<A>(args)...);
+
+	return SendRequest(serializerIn, serializerOut);
+}
+
+// Sends M without waiting for the reply, so that many requests can be in flight at once.
+// 'completion' is called with the reply, or with 'failValue' if the server couldn't be reached.
+// It runs on the connection's reader thread, unless the server doesn't support pipelining.
+template<PipeMessages M, typename C, typename ...A>
+void requestAsync(C completion, typename MessageSchema<M>::Reply failValue, A&&... args)
+{
+	typedef typename MessageSchema<M>::Reply Reply;
+
+	if (!IsFeatureSupported(FeaturePipelining))
+		return completion(requestOr<M>(failValue, std::forward<A>(args)...));
+
+	POOLED_SERIALIZERS(serializerIn, serializerOut)
+
+	unsigned int requestId = NextRequestId();
+	encodeTaggedMessage<M>(serializerIn, requestId, std::forward<A>(args)...);
+
+	SendAsyncRequest(serializerIn, requestId, [completion, failValue](bool bSuccess, Serializer& reply)
+	{
+		if (!bSuccess)
+			return completion(failValue);
+
+		Reply value;
+		reply >> value;
+		completion(value);
+	});
+}
+
+// Like requestAsync(), but the reply is delivered through a future
+template<PipeMessages M, typename ...A>
+std::future<typename MessageSchema<M>::Reply> requestFuture(typename MessageSchema<M>::Reply failValue, A&&... args)
+{
+	typedef typename MessageSchema<M>::Reply Reply;
+
+	auto promise = std::make_shared<std::promise<Reply> >();
+	std::future<Reply> result = promise->get_future();
+
+	requestAsync<M>([promise](const Reply& reply) { promise->set_value(reply); }, failValue, std::forward<A>(args)...);
+
+	return result;
+}
+
+// Sends M one-way, it is only queued and a failure is reported by the next OverlaySync()
+template<PipeMessages M, typename ...A>
+bool post(A&&... args)
+{
+	POOLED_SERIALIZERS(serializerIn, serializerOut)
+
+	encodeOneWayMessage<M>(serializerIn, std::forward<A>(args)...);
+
+	return PostRequest(serializerIn);
+}
+
+// Setters return 1 on success. In one-way mode they return as soon as the message has been sent,
+// inside of a batch as soon as it has been added to it.
+template<PipeMessages M, typename ...A>
+int setter(A&&... args)
+{
+	static_assert(IsSetter<M>::value, "Not a setter message, add it to SETTER_MESSAGE");
+
+	if (CommandBatch *batch = GetActiveBatch())
+	{
+		encodeMessage<M>(batch->commands, std::forward<A>(args)...);
+		batch->count++;
+		return 1;
+	}
+
+	if (IsOneWayEnabled())
+		return post<M>(std::forward<A>(args)...) ? 1 : 0;
+
+	return requestOr<M>(0, std::forward<A>(args)...);
+}
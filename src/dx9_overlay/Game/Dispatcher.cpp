@@ -0,0 +1,47 @@
+#include "Dispatcher.h"
+#include "Game.h"
+#include "Messagehandler.h"
+
+void dispatchRequest(Serializer& serializerIn, Serializer& serializerOut)
+{
+	SERIALIZATION_READ(serializerIn, PipeMessages, eMessage);
+
+	// The transports don't send a reply for one-way messages, a failure is only counted for the next Sync
+	bool bOneWay = (short(eMessage) & PROTOCOL_ONE_WAY_FLAG) != 0;
+	bool bTagged = (short(eMessage) & PROTOCOL_REQUEST_ID_FLAG) != 0;
+	eMessage = PipeMessages(short(eMessage) & ~(PROTOCOL_ONE_WAY_FLAG | PROTOCOL_REQUEST_ID_FLAG));
+
+	// Pipelined requests are matched with their reply by the id in front of it. One-way requests
+	// aren't answered, their reply only holds the result.
+	if (bTagged)
+	{
+		SERIALIZATION_READ(serializerIn, unsigned int, requestId);
+		if (!bOneWay)
+			serializerOut << requestId;
+	}
+
+	try
+	{
+		MessageDispatcher dispatcher = MessageTable<>::find(eMessage);
+		if (!dispatcher)
+		{
+			if (bOneWay)
+				g_oneWayFailures++;
+			return;
+		}
+
+		dispatcher(serializerIn, serializerOut);
+
+		if (bOneWay)
+		{
+			SERIALIZATION_READ(serializerOut, int, iResult);
+			if (iResult == 0)
+				g_oneWayFailures++;
+		}
+	}
+	catch (...)
+	{
+		if (bOneWay)
+			g_oneWayFailures++;
+	}
+}
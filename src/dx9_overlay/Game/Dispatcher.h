@@ -0,0 +1,6 @@
+#pragma once
+#include <Utils/Serializer.h>
+
+// Decodes a request of any transport, calls its handler and encodes the reply.
+// Called concurrently by the transports' threads, see MessageLock for the ordering.
+void dispatchRequest(Serializer& serializerIn, Serializer& serializerOut);
@@ -2,22 +2,31 @@
 #include <Utils/Hook.h>
 #include <Utils/Pattern.h>
 #include <Utils/PipeServer.h>
+#include <Utils/SharedMemoryServer.h>
+#include <Utils/EventServer.h>
+#include <Shared/Config.h>
 
 #include "Game.h"
-#include "Messagehandler.h"
+#include "Dispatcher.h"
 
 #include "Rendering/Renderer.h"
+#include "Rendering/D3D9Device.h"
 
 #include <d3dx9.h>
 
-#define BIND(T) PaketHandler[PipeMessages::T] = std::bind(T, std::placeholders::_1, std::placeholders::_2);
-
 Hook<CallConvention::stdcall_t, HRESULT, LPDIRECT3DDEVICE9, CONST RECT *, CONST RECT *, HWND, CONST RGNDATA *> g_presentHook;
 Hook<CallConvention::stdcall_t, HRESULT, LPDIRECT3DDEVICE9, D3DPRESENT_PARAMETERS *> g_resetHook;
 
 Renderer g_pRenderer;
+SharedMemoryServer *g_pSharedMemoryServer = nullptr;
+std::atomic<int> g_oneWayFailures(0);
 bool g_bEnabled = false;
 
+int openSharedMemoryChannel(int processId)
+{
+	return g_pSharedMemoryServer ? g_pSharedMemoryServer->openChannel((DWORD) processId) : 0;
+}
+
 extern "C" __declspec(dllexport) void enable()
 {
 	g_bEnabled = true;
@@ -34,10 +43,17 @@ void initGame()
 	DWORD dwDevice = findPattern((DWORD) hMod, 0x128000, (PBYTE)"\xC7\x06\x00\x00\x00\x00\x89\x86\x00\x00\x00\x00\x89\x86", "xx????xx????xx");
 	memcpy(&vtbl, (void *) (dwDevice + 0x2), 4);
 
+	// Started before the hooks, so the first frame's events already reach the clients
+	EventServer *pEventServer = new EventServer();
+	g_pRenderer.setEventCallback(boost::bind(&EventServer::publish, pEventServer, _1, _2, _3));
+
 	g_presentHook.apply(vtbl[17], [](LPDIRECT3DDEVICE9 dev, CONST RECT * a1, CONST RECT * a2, HWND a3, CONST RGNDATA *a4) -> HRESULT
 	{
 		__asm pushad
-		g_pRenderer.draw(dev);
+		{
+			D3D9Device device(dev);
+			g_pRenderer.draw(&device);
+		}
 		__asm popad
 
 		return g_presentHook.callOrig(dev, a1, a2, a3, a4);
@@ -46,80 +62,25 @@ void initGame()
 	g_resetHook.apply(vtbl[16], [](LPDIRECT3DDEVICE9 dev, D3DPRESENT_PARAMETERS *pp) -> HRESULT
 	{
 		__asm pushad
-		g_pRenderer.reset(dev);
+		{
+			D3D9Device device(dev);
+			g_pRenderer.reset(&device);
+		}
 		__asm popad
 
 		return g_resetHook.callOrig(dev, pp);
 	});
 
-	typedef std::map<PipeMessages, std::function<void(Serializer&, Serializer&)> > MessagePaketHandler;
-	MessagePaketHandler PaketHandler;
-
-	BIND(TextCreate);
-	BIND(TextCreateUnicode);
-	BIND(TextDestroy);
-	BIND(TextSetShadow);
-	BIND(TextSetShown);
-	BIND(TextSetColor);
-	BIND(TextSetPos);
-	BIND(TextSetString);
-	BIND(TextSetStringUnicode);
-	BIND(TextUpdate);
-	BIND(TextUpdateUnicode);
-
-	BIND(BoxCreate);
-	BIND(BoxDestroy);
-	BIND(BoxSetShown);
-	BIND(BoxSetBorder);
-	BIND(BoxSetBorderColor);
-	BIND(BoxSetColor);
-	BIND(BoxSetHeight);
-	BIND(BoxSetPos);
-	BIND(BoxSetWidth);
-
-	BIND(LineCreate);
-	BIND(LineDestroy);
-	BIND(LineSetShown);
-	BIND(LineSetColor);
-	BIND(LineSetWidth);
-	BIND(LineSetPos);
-
-	BIND(ImageCreate);
-	BIND(ImageDestroy);
-	BIND(ImageSetShown);
-	BIND(ImageSetAlign);
-	BIND(ImageSetPos);
-	BIND(ImageSetRotation);
-
-	BIND(DestroyAllVisual);
-	BIND(ShowAllVisual);
-	BIND(HideAllVisual);
-
-	BIND(GetFrameRate);
-	BIND(GetScreenSpecs);
-
-	BIND(SetCalculationRatio);
-	BIND(SetOverlayPriority);
-
-	new PipeServer([&](Serializer& serializerIn, Serializer& serializerOut)
-	{
-		SERIALIZATION_READ(serializerIn, PipeMessages, eMessage);
-
-		try
-		{
-			auto it = PaketHandler.find(eMessage);
-			if (it == PaketHandler.end())
-				return;
+	g_pSharedMemoryServer = new SharedMemoryServer(&dispatchRequest);
+	new PipeServer(&dispatchRequest);
 
-			if (!PaketHandler[eMessage])
-				return;
+	// Lets Init() of the client continue, the event is kept for the lifetime of the process
+	char szReadyEvent[MAX_PATH + 1] = { 0 };
+	sprintf_s(szReadyEvent, g_strReadyEventFormat, GetCurrentProcessId());
 
-			PaketHandler[eMessage](serializerIn, serializerOut);
-		}
-		catch (...)
-		{
-		}
-	});
+	HANDLE hReady = CreateEventA(NULL, TRUE, FALSE, szReadyEvent);
+	if (hReady != NULL)
+		SetEvent(hReady);
 
 	while (true){
 		Sleep(100);
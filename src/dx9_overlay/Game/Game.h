@@ -1,5 +1,14 @@
 #pragma once
+#include <atomic>
+
 
 extern class Renderer g_pRenderer;
 
+// Failed one-way messages since the last PipeMessages::Sync
+extern std::atomic<int> g_oneWayFailures;
+
+// Creates a SharedMemoryChannel for a client process and returns its id, 0 if there's none.
+// Defined next to the other Windows-only parts, so that the dispatcher doesn't depend on them.
+int openSharedMemoryChannel(int processId);
+
 void initGame();
\ No newline at end of file
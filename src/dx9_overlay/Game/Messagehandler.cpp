@@ -1,4 +1,4 @@
-#include <Utils/SafeBlock.h>
+#include <Utils/StringTable.h>
 
 #include "Messagehandler.h"
 #include "Game.h"
@@ -9,388 +9,375 @@
 #include "Rendering/Renderer.h"
 #include "Rendering/RenderBase.h"
 
-#define READ(X, Y) SERIALIZATION_READ(serializerIn, X, Y);
-#define WRITE(X) serializerOut << X;
+// Strings registered by StringIntern, shared by all clients of this server until the last one releases them
+StringTable g_internedStrings(1024);
 
-void TextCreate(Serializer& serializerIn, Serializer& serializerOut)
-{
-	READ(std::string, Font); 
-	READ(int, FontSize); 
-	READ(bool, bBold);
-	READ(bool, bItalic);
-	READ(int, x); 
-	READ(int, y);
-	READ(unsigned int, color);
-	READ(std::string, string);
-	READ(bool, bShadow);
-	READ(bool, bShow);
+#define OBJECT_MUTEXES	64
+
+std::mutex g_objectMutexes[OBJECT_MUTEXES];
 
-	WRITE(g_pRenderer.add(std::make_shared<Text>(&g_pRenderer, Font, FontSize, bBold, bItalic, x, y, color, string, bShadow, bShow)));
+std::mutex& objectMutex(int id)
+{
+	return g_objectMutexes[(unsigned int) id % OBJECT_MUTEXES];
 }
 
-void TextCreateUnicode(Serializer& serializerIn, Serializer& serializerOut)
+// Handlers only queue their change, the render thread applies the last one of each property before the next frame.
+// The values are copied into the command, 'apply' gets them together with the object, which is always a T.
+template<typename T, typename ...V>
+static int queueUpdate(int id, PipeMessages property, Renderer::ApplyUpdate apply, V... values)
 {
-	READ(std::wstring, Font);
-	READ(int, FontSize);
-	READ(bool, bBold);
-	READ(bool, bItalic);
-	READ(int, x);
-	READ(int, y);
-	READ(unsigned int, color);
-	READ(std::wstring, string);
-	READ(bool, bShadow);
-	READ(bool, bShow);
+	auto object = g_pRenderer.getAs<T>(id);
+	if (!object)
+		return 0;
 
-	WRITE(g_pRenderer.add(std::make_shared<Text>(&g_pRenderer, Font, FontSize, bBold, bItalic, x, y, color, string, bShadow, bShow)));
+	g_pRenderer.queueUpdate(std::move(object), int(property), apply, values...);
+	return 1;
 }
 
-void TextDestroy(Serializer& serializerIn, Serializer& serializerOut)
+void Handler::Ping()
 {
-	READ(int, id);
-	WRITE(int(g_pRenderer.remove(id)));
 }
 
-void TextSetShadow(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::TextCreate(boost::string_ref Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, boost::string_ref string, bool bShadow, bool bShow)
 {
-	READ(int, id); 
-	READ(bool, bShadow);
-	
-	WRITE(int(safeExecuteWithValidation([&](){ 
-		g_pRenderer.getAs<Text>(id)->setShadow(bShadow); 
-	})));
+	return g_pRenderer.add(std::make_shared<Text>(&g_pRenderer, Font, FontSize, bBold, bItalic, x, y, color, string, bShadow, bShow));
 }
 
-void TextSetShown(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::TextDestroy(int id)
 {
-	READ(int, id); 
-	READ(bool, bShown);
-
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Text>(id)->setShown(bShown);
-	})));
+	return int(g_pRenderer.remove(id));
 }
 
-void TextSetColor(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::TextSetShadow(int id, bool bShadow)
 {
-	READ(int, id); 
-	READ(unsigned int, color);
-
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Text>(id)->setColor(color);
-	})));
+	return queueUpdate<Text>(id, PipeMessages::TextSetShadow, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Text *>(object)->setShadow(update.values[0] != 0);
+	}, bShadow);
 }
 
-void TextSetPos(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::TextSetShown(int id, bool bShown)
 {
-	READ(int, id); 
-	READ(int, x); 
-	READ(int, y);
-
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Text>(id)->setPos(x, y);
-	})));
+	return queueUpdate<Text>(id, PipeMessages::TextSetShown, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Text *>(object)->setShown(update.values[0] != 0);
+	}, bShown);
 }
 
-void TextSetString(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::TextSetColor(int id, unsigned int color)
 {
-	READ(int, id); 
-	READ(std::string, str);
-
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Text>(id)->setText(str);
-	})));
+	return queueUpdate<Text>(id, PipeMessages::TextSetColor, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Text *>(object)->setColor((unsigned int) update.values[0]);
+	}, color);
 }
 
-void TextSetStringUnicode(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::TextSetPos(int id, int x, int y)
 {
-	READ(int, id);
-	READ(std::wstring, str);
-
-	WRITE(int(safeExecuteWithValidation([&]() {
-		g_pRenderer.getAs<Text>(id)->setText(str);
-	})));
+	return queueUpdate<Text>(id, PipeMessages::TextSetPos, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Text *>(object)->setPos(update.values[0], update.values[1]);
+	}, x, y);
 }
 
-void TextUpdate(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::TextSetString(int id, boost::string_ref str)
 {
-	READ(int, id); 
-	READ(std::string, Font); 
-	READ(int, FontSize); 
-	READ(bool, bBold); 
-	READ(bool, bItalic);
-
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Text>(id)->updateText(Font, FontSize, bBold, bItalic);
-	})));
+	// Copied into the command, the string is only valid until the handler returns
+	return queueUpdate<Text>(id, PipeMessages::TextSetString, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Text *>(object)->setText(update.text);
+	}, str);
 }
 
-void TextUpdateUnicode(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::TextUpdate(int id, boost::string_ref Font, int FontSize, bool bBold, bool bItalic)
 {
-	READ(int, id);
-	READ(std::wstring, Font);
-	READ(int, FontSize);
-	READ(bool, bBold);
-	READ(bool, bItalic);
-
-	WRITE(int(safeExecuteWithValidation([&]() {
-		g_pRenderer.getAs<Text>(id)->updateText(Font, FontSize, bBold, bItalic);
-	})));
+	return queueUpdate<Text>(id, PipeMessages::TextUpdate, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Text *>(object)->updateText(update.text, update.values[0], update.values[1] != 0, update.values[2] != 0);
+	}, Font, FontSize, bBold, bItalic);
 }
 
-void BoxCreate(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::BoxCreate(int x, int y, int w, int h, unsigned int dwColor, bool bShow)
 {
-	READ(int, x); 
-	READ(int, y); 
-	READ(int, w); 
-	READ(int, h); 
-	READ(unsigned int, dwColor); 
-	READ(bool, bShow);
-
-	WRITE(g_pRenderer.add(std::make_shared<Box>(&g_pRenderer, x, y, w, h, dwColor, bShow)));
+	return g_pRenderer.add(std::make_shared<Box>(&g_pRenderer, x, y, w, h, dwColor, bShow));
 }
 
-void BoxDestroy(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::BoxDestroy(int id)
 {
-	READ(int, id);
-	WRITE((int) g_pRenderer.remove(id));
+	return (int) g_pRenderer.remove(id);
 }
 
-void BoxSetShown(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::BoxSetShown(int id, bool bShown)
 {
-	READ(int, id); 
-	READ(bool, bShown);
-
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Box>(id)->setShown(bShown);
-	})));
+	return queueUpdate<Box>(id, PipeMessages::BoxSetShown, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Box *>(object)->setShown(update.values[0] != 0);
+	}, bShown);
 }
 
-void BoxSetBorder(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::BoxSetBorder(int id, int height, bool bShown)
 {
-	READ(int, id); 
-	READ(int, height); 
-	READ(bool, bShown);
-
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Box>(id)->setBorderWidth(height);
-		g_pRenderer.getAs<Box>(id)->setBorderShown(bShown);
-	})));
+	return queueUpdate<Box>(id, PipeMessages::BoxSetBorder, [](RenderBase *object, const Renderer::Update& update){
+		Box *box = static_cast<Box *>(object);
+		box->setBorderWidth(update.values[0]);
+		box->setBorderShown(update.values[1] != 0);
+	}, height, bShown);
 }
 
-void BoxSetBorderColor(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::BoxSetBorderColor(int id, unsigned int dwColor)
 {
-	READ(int, id); 
-	READ(unsigned int, dwColor);
-
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Box>(id)->setBorderColor(dwColor);
-	})));
+	return queueUpdate<Box>(id, PipeMessages::BoxSetBorderColor, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Box *>(object)->setBorderColor((unsigned int) update.values[0]);
+	}, dwColor);
 }
 
-void BoxSetColor(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::BoxSetColor(int id, unsigned int dwColor)
 {
-	READ(int, id); 
-	READ(unsigned int, dwColor);
-
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Box>(id)->setBoxColor(dwColor);
-	})));
+	return queueUpdate<Box>(id, PipeMessages::BoxSetColor, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Box *>(object)->setBoxColor((unsigned int) update.values[0]);
+	}, dwColor);
 }
 
-void BoxSetHeight(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::BoxSetHeight(int id, int height)
 {
-	READ(int, id); 
-	READ(int, height);
-
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Box>(id)->setBoxHeight(height);
-	})));
+	return queueUpdate<Box>(id, PipeMessages::BoxSetHeight, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Box *>(object)->setBoxHeight(update.values[0]);
+	}, height);
 }
 
-void BoxSetPos(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::BoxSetPos(int id, int x, int y)
 {
-	READ(int, id); 
-	READ(int, x); 
-	READ(int, y);
-
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Box>(id)->setPos(x, y);
-	})));
+	return queueUpdate<Box>(id, PipeMessages::BoxSetPos, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Box *>(object)->setPos(update.values[0], update.values[1]);
+	}, x, y);
 }
 
-void BoxSetWidth(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::BoxSetWidth(int id, int width)
 {
-	READ(int, id); 
-	READ(int, width);
+	return queueUpdate<Box>(id, PipeMessages::BoxSetWidth, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Box *>(object)->setBoxWidth(update.values[0]);
+	}, width);
+}
 
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Box>(id)->setBoxWidth(width);
-	})));
+int Handler::LineCreate(int x1, int y1, int x2, int y2, int width, unsigned int color, bool bShow)
+{
+	return g_pRenderer.add(std::make_shared<Line>(&g_pRenderer, x1, y1, x2, y2, width, color, bShow));
 }
 
-void LineCreate(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::LineDestroy(int id)
 {
-	READ(int, x1); 
-	READ(int, y1); 
-	READ(int, x2); 
-	READ(int, y2); 
-	READ(int, width); 
-	READ(unsigned int, color);
-	READ(bool, bShow);
+	return (int) g_pRenderer.remove(id);
+}
 
-	WRITE(g_pRenderer.add(std::make_shared<Line>(&g_pRenderer, x1, y1, x2, y2, width, color, bShow)));
+int Handler::LineSetShown(int id, bool bShown)
+{
+	return queueUpdate<Line>(id, PipeMessages::LineSetShown, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Line *>(object)->setShown(update.values[0] != 0);
+	}, bShown);
 }
 
-void LineDestroy(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::LineSetColor(int id, unsigned int color)
 {
-	READ(int, id);
-	WRITE((int) g_pRenderer.remove(id));
+	return queueUpdate<Line>(id, PipeMessages::LineSetColor, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Line *>(object)->setColor((unsigned int) update.values[0]);
+	}, color);
 }
 
-void LineSetShown(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::LineSetWidth(int id, int width)
 {
-	READ(int, id); 
-	READ(bool, bShown);
+	return queueUpdate<Line>(id, PipeMessages::LineSetWidth, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Line *>(object)->setWidth(update.values[0]);
+	}, width);
+}
 
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Line>(id)->setShown(bShown);
-	})));
+int Handler::LineSetPos(int id, int x1, int y1, int x2, int y2)
+{
+	return queueUpdate<Line>(id, PipeMessages::LineSetPos, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Line *>(object)->setPos(update.values[0], update.values[1], update.values[2], update.values[3]);
+	}, x1, y1, x2, y2);
 }
 
-void LineSetColor(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::ImageCreate(boost::string_ref path, int x, int y, int rotation, int align, bool show)
 {
-	READ(int, id); 
-	READ(unsigned int, color);
+	return g_pRenderer.add(std::make_shared<Image>(&g_pRenderer, path.to_string(), x, y, rotation, align, show));
+}
 
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Line>(id)->setColor(color);
-	})));
+int Handler::ImageDestroy(int id)
+{
+	return (int) g_pRenderer.remove(id);
 }
 
-void LineSetWidth(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::ImageSetShown(int id, bool bShow)
 {
-	READ(int, id); 
-	READ(int, width);
+	return queueUpdate<Image>(id, PipeMessages::ImageSetShown, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Image *>(object)->setShown(update.values[0] != 0);
+	}, bShow);
+}
 
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Line>(id)->setWidth(width);
-	})));
+int Handler::ImageSetAlign(int id, int align)
+{
+	return queueUpdate<Image>(id, PipeMessages::ImageSetAlign, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Image *>(object)->setAlign(update.values[0]);
+	}, align);
 }
 
-void LineSetPos(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::ImageSetPos(int id, int x, int y)
 {
-	READ(int, id); 
-	READ(int, x1); 
-	READ(int, y1); 
-	READ(int, x2); 
-	READ(int, y2);
+	return queueUpdate<Image>(id, PipeMessages::ImageSetPos, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Image *>(object)->setPos(update.values[0], update.values[1]);
+	}, x, y);
+}
 
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Line>(id)->setPos(x1, y1, x2, y2);
-	})));
+int Handler::ImageSetRotation(int id, int rotation)
+{
+	return queueUpdate<Image>(id, PipeMessages::ImageSetRotation, [](RenderBase *object, const Renderer::Update& update){
+		static_cast<Image *>(object)->setRotation(update.values[0]);
+	}, rotation);
 }
 
-void ImageCreate(Serializer& serializerIn, Serializer& serializerOut)
+
+void Handler::DestroyAllVisual()
 {
-	READ(std::string, path); 
-	READ(int, x); 
-	READ(int, y); 
-	READ(int, rotation); 
-	READ(int, align); 
-	READ(bool, show);
-	
-	WRITE(g_pRenderer.add(std::make_shared<Image>(&g_pRenderer, path.c_str(), x, y, rotation, align, show)));
+	g_pRenderer.destroyAll();
 }
 
-void ImageDestroy(Serializer& serializerIn, Serializer& serializerOut)
+void Handler::ShowAllVisual()
 {
-	READ(int, id);
-	WRITE((int) g_pRenderer.remove(id));
+	g_pRenderer.showAll();
 }
 
-void ImageSetShown(Serializer& serializerIn, Serializer& serializerOut)
+void Handler::HideAllVisual()
 {
-	READ(int, id); 
-	READ(bool, bShow);
+	g_pRenderer.hideAll();
+}
 
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Image>(id)->setShown(bShow);
-	})));
+int Handler::GetFrameRate()
+{
+	return g_pRenderer.frameRate();
 }
 
-void ImageSetAlign(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::GetCoalescedUpdates()
 {
-	READ(int, id); 
-	READ(int, align);
+	return g_pRenderer.coalescedUpdates();
+}
 
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Image>(id)->setAlign(align);
-	})));
+ScreenSpecs Handler::GetScreenSpecs()
+{
+	return std::make_pair(g_pRenderer.screenWidth(), g_pRenderer.screenHeight());
 }
 
-void ImageSetPos(Serializer& serializerIn, Serializer& serializerOut)
+void Handler::SetCalculationRatio(int width, int height)
 {
-	READ(int, id); 
-	READ(int, x); 
-	READ(int, y);
+	RenderBase::xCalculator = width;
+	RenderBase::yCalculator = height;
+}
 
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Image>(id)->setPos(x, y);
-	})));
+int Handler::SetOverlayPriority(int id, int priority)
+{
+	return queueUpdate<RenderBase>(id, PipeMessages::SetOverlayPriority, [](RenderBase *object, const Renderer::Update& update){
+		object->setPriority(update.values[0]);
+	}, priority);
 }
 
-void ImageSetRotation(Serializer& serializerIn, Serializer& serializerOut)
+ServerInfo Handler::Handshake(int clientVersion)
 {
-	READ(int, id); 
-	READ(int, rotation);
+	ServerInfo info;
+	info.protocolVersion = PROTOCOL_VERSION;
+	info.maxMessageSize = PROTOCOL_MAX_MESSAGE_SIZE;
+	info.encodings = EncodingBinary;
+	info.features = FeatureLargeMessages | FeatureStringInterning | FeatureSharedMemory |
+		FeatureOneWay | FeatureBatching | FeaturePipelining | FeatureEvents | FeatureBulkUpdate;
 
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.getAs<Image>(id)->setRotation(rotation);
-	})));
+	// Nothing else is understood by a client of another version, it only learns ours and gives up
+	if (clientVersion != PROTOCOL_VERSION)
+	{
+		info.encodings = 0;
+		info.features = 0;
+	}
+
+	return info;
 }
 
+int Handler::StringIntern(boost::string_ref str)
+{
+	return g_internedStrings.intern(str);
+}
 
-void DestroyAllVisual(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::StringRelease(int handle)
 {
-	g_pRenderer.destroyAll();
+	return int(g_internedStrings.release(handle));
 }
 
-void ShowAllVisual(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::TextCreateInterned(int Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, boost::string_ref string, bool bShadow, bool bShow)
 {
-	g_pRenderer.showAll();
+	std::string fontName;
+	if (!g_internedStrings.lookup(Font, fontName))
+		return -1;
+
+	return TextCreate(fontName, FontSize, bBold, bItalic, x, y, color, string, bShadow, bShow);
 }
 
-void HideAllVisual(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::TextUpdateInterned(int id, int Font, int FontSize, bool bBold, bool bItalic)
 {
-	g_pRenderer.hideAll();
+	std::string fontName;
+	if (!g_internedStrings.lookup(Font, fontName))
+		return 0;
+
+	return TextUpdate(id, fontName, FontSize, bBold, bItalic);
 }
 
-void GetFrameRate(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::OpenSharedMemory(int processId)
 {
-	WRITE(g_pRenderer.frameRate());
+	return openSharedMemoryChannel(processId);
 }
 
-void GetScreenSpecs(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::Sync()
 {
-	WRITE(g_pRenderer.screenWidth()); 
-	WRITE(g_pRenderer.screenHeight());
+	return g_oneWayFailures.exchange(0);
 }
 
-void SetCalculationRatio(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::Batch(int count, boost::string_ref commands)
 {
-	READ(int, width);
-	READ(int, height);
+	Serializer serializerIn(commands.data(), (unsigned int) commands.size());
+	Serializer serializerOut;
 
-	RenderBase::xCalculator = width;
-	RenderBase::yCalculator = height;
+	// The setters' updates are queued together, a frame shows either none or all of the changes
+	Renderer::UpdateGroup group(g_pRenderer);
+
+	int failed = 0;
+	for (int i = 0; i < count; i++)
+	{
+		SERIALIZATION_READ(serializerIn, PipeMessages, eMessage);
+
+		// Only setters may be part of a batch. The size of any other message isn't known,
+		// so the remaining commands can't be found.
+		MessageDispatcher dispatcher = MessageTable<true>::find(eMessage);
+		if (!dispatcher)
+			return failed + count - i;
+
+		serializerOut.clear();
+		dispatcher(serializerIn, serializerOut);
+
+		SERIALIZATION_READ(serializerOut, int, iResult);
+		if (iResult == 0)
+			failed++;
+	}
+
+	return failed;
 }
 
-void SetOverlayPriority(Serializer& serializerIn, Serializer& serializerOut)
+int Handler::BulkUpdate(int count, boost::string_ref records)
 {
-	READ(int, id);
-	READ(int, priority);
+	if (count <= 0)
+		return 0;
 
-	WRITE(int(safeExecuteWithValidation([&](){
-		g_pRenderer.get(id)->setPriority(priority);
-	})));
-}
+	// Every record takes at least three bytes, a larger count can't be right
+	if ((size_t) count > records.size() / 3)
+		return count;
+
+	Serializer serializerIn(records.data(), (unsigned int) records.size());
+
+	std::vector<Renderer::PropertyUpdate> updates(count);
+	for (auto it = updates.begin(); it != updates.end(); it++)
+	{
+		int iProperty = 0;
+		serializerIn >> it->id >> iProperty >> it->value;
+
+		it->property = (OverlayProperty) iProperty;
+	}
+
+	return g_pRenderer.setProperties(updates);
+}
\ No newline at end of file
@@ -1,52 +1,269 @@
 #pragma once
 #include <Utils/Serializer.h>
 #include <Shared/PipeMessages.h>
+#include <Shared/MessageSchema.h>
 
-#include <functional>
-
-void TextCreate(Serializer& serializerIn, Serializer& serializerOut);
-void TextCreateUnicode(Serializer& serializerIn, Serializer& serializerOut);
-void TextDestroy(Serializer& serializerIn, Serializer& serializerOut);
-void TextSetShadow(Serializer& serializerIn, Serializer& serializerOut);
-void TextSetShown(Serializer& serializerIn, Serializer& serializerOut);
-void TextSetColor(Serializer& serializerIn, Serializer& serializerOut);
-void TextSetPos(Serializer& serializerIn, Serializer& serializerOut);
-void TextSetString(Serializer& serializerIn, Serializer& serializerOut);
-void TextSetStringUnicode(Serializer& serializerIn, Serializer& serializerOut);
-void TextUpdate(Serializer& serializerIn, Serializer& serializerOut);
-void TextUpdateUnicode(Serializer& serializerIn, Serializer& serializerOut);
-
-void BoxCreate(Serializer& serializerIn, Serializer& serializerOut);
-void BoxDestroy(Serializer& serializerIn, Serializer& serializerOut);
-void BoxSetShown(Serializer& serializerIn, Serializer& serializerOut);
-void BoxSetBorder(Serializer& serializerIn, Serializer& serializerOut);
-void BoxSetBorderColor(Serializer& serializerIn, Serializer& serializerOut);
-void BoxSetColor(Serializer& serializerIn, Serializer& serializerOut);
-void BoxSetHeight(Serializer& serializerIn, Serializer& serializerOut);
-void BoxSetPos(Serializer& serializerIn, Serializer& serializerOut);
-void BoxSetWidth(Serializer& serializerIn, Serializer& serializerOut);
-
-void LineCreate(Serializer& serializerIn, Serializer& serializerOut);
-void LineDestroy(Serializer& serializerIn, Serializer& serializerOut);
-void LineSetShown(Serializer& serializerIn, Serializer& serializerOut);
-void LineSetColor(Serializer& serializerIn, Serializer& serializerOut);
-void LineSetWidth(Serializer& serializerIn, Serializer& serializerOut);
-void LineSetPos(Serializer& serializerIn, Serializer& serializerOut);
-
-void ImageCreate(Serializer& serializerIn, Serializer& serializerOut);
-void ImageDestroy(Serializer& serializerIn, Serializer& serializerOut);
-void ImageSetShown(Serializer& serializerIn, Serializer& serializerOut);
-void ImageSetAlign(Serializer& serializerIn, Serializer& serializerOut);
-void ImageSetPos(Serializer& serializerIn, Serializer& serializerOut);
-void ImageSetRotation(Serializer& serializerIn, Serializer& serializerOut);
-
-void DestroyAllVisual(Serializer& serializerIn, Serializer& serializerOut);
-void ShowAllVisual(Serializer& serializerIn, Serializer& serializerOut);
-void HideAllVisual(Serializer& serializerIn, Serializer& serializerOut);
-
-void GetFrameRate(Serializer& serializerIn, Serializer& serializerOut);
-void GetScreenSpecs(Serializer& serializerIn, Serializer& serializerOut);
-
-void SetCalculationRatio(Serializer& serializerIn, Serializer& serializerOut);
-
-void SetOverlayPriority(Serializer& serializerIn, Serializer& serializerOut);
\ No newline at end of file
+#include <mutex>
+
+// Handlers receive the arguments described by MessageSchema and return its reply type
+namespace Handler
+{
+	void Ping();
+
+	int TextCreate(boost::string_ref Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, boost::string_ref string, bool bShadow, bool bShow);
+	int TextDestroy(int id);
+	int TextSetShadow(int id, bool bShadow);
+	int TextSetShown(int id, bool bShown);
+	int TextSetColor(int id, unsigned int color);
+	int TextSetPos(int id, int x, int y);
+	int TextSetString(int id, boost::string_ref str);
+	int TextUpdate(int id, boost::string_ref Font, int FontSize, bool bBold, bool bItalic);
+
+	int BoxCreate(int x, int y, int w, int h, unsigned int dwColor, bool bShow);
+	int BoxDestroy(int id);
+	int BoxSetShown(int id, bool bShown);
+	int BoxSetBorder(int id, int height, bool bShown);
+	int BoxSetBorderColor(int id, unsigned int dwColor);
+	int BoxSetColor(int id, unsigned int dwColor);
+	int BoxSetHeight(int id, int height);
+	int BoxSetPos(int id, int x, int y);
+	int BoxSetWidth(int id, int width);
+
+	int LineCreate(int x1, int y1, int x2, int y2, int width, unsigned int color, bool bShow);
+	int LineDestroy(int id);
+	int LineSetShown(int id, bool bShown);
+	int LineSetColor(int id, unsigned int color);
+	int LineSetWidth(int id, int width);
+	int LineSetPos(int id, int x1, int y1, int x2, int y2);
+
+	int ImageCreate(boost::string_ref path, int x, int y, int rotation, int align, bool show);
+	int ImageDestroy(int id);
+	int ImageSetShown(int id, bool bShow);
+	int ImageSetAlign(int id, int align);
+	int ImageSetPos(int id, int x, int y);
+	int ImageSetRotation(int id, int rotation);
+
+	void DestroyAllVisual();
+	void ShowAllVisual();
+	void HideAllVisual();
+
+	int GetFrameRate();
+	int GetCoalescedUpdates();
+	ScreenSpecs GetScreenSpecs();
+
+	void SetCalculationRatio(int width, int height);
+
+	int SetOverlayPriority(int id, int priority);
+
+	ServerInfo Handshake(int clientVersion);
+
+	int StringIntern(boost::string_ref str);
+	int StringRelease(int handle);
+	int TextCreateInterned(int Font, int FontSize, bool bBold, bool bItalic, int x, int y, unsigned int color, boost::string_ref string, bool bShadow, bool bShow);
+	int TextUpdateInterned(int id, int Font, int FontSize, bool bBold, bool bItalic);
+
+	int OpenSharedMemory(int processId);
+
+	int Sync();
+
+	int Batch(int count, boost::string_ref commands);
+	int BulkUpdate(int count, boost::string_ref records);
+}
+
+// Binds a PipeMessages entry to the handler of the same name.
+// Every message needs exactly one binding, otherwise dispatchMessage fails to compile.
+template<PipeMessages M>
+struct MessageHandler
+{
+	enum { defined = false };
+};
+
+#define BIND(M)																\
+template<> struct MessageHandler<PipeMessages::M>							\
+{																			\
+	enum { defined = true };												\
+																			\
+	template<typename ...T>													\
+	static MessageSchema<PipeMessages::M>::Reply invoke(T&... args)			\
+	{																		\
+		return Handler::M(args...);											\
+	}																		\
+}
+
+BIND(Ping);
+
+BIND(TextCreate);
+BIND(TextDestroy);
+BIND(TextSetShadow);
+BIND(TextSetShown);
+BIND(TextSetColor);
+BIND(TextSetPos);
+BIND(TextSetString);
+BIND(TextUpdate);
+
+BIND(BoxCreate);
+BIND(BoxDestroy);
+BIND(BoxSetShown);
+BIND(BoxSetBorder);
+BIND(BoxSetBorderColor);
+BIND(BoxSetColor);
+BIND(BoxSetHeight);
+BIND(BoxSetPos);
+BIND(BoxSetWidth);
+
+BIND(LineCreate);
+BIND(LineDestroy);
+BIND(LineSetShown);
+BIND(LineSetColor);
+BIND(LineSetWidth);
+BIND(LineSetPos);
+
+BIND(ImageCreate);
+BIND(ImageDestroy);
+BIND(ImageSetShown);
+BIND(ImageSetAlign);
+BIND(ImageSetPos);
+BIND(ImageSetRotation);
+
+BIND(DestroyAllVisual);
+BIND(ShowAllVisual);
+BIND(HideAllVisual);
+
+BIND(GetFrameRate);
+BIND(GetScreenSpecs);
+
+BIND(SetCalculationRatio);
+BIND(SetOverlayPriority);
+
+BIND(Handshake);
+
+BIND(StringIntern);
+BIND(TextCreateInterned);
+BIND(TextUpdateInterned);
+
+BIND(OpenSharedMemory);
+BIND(Sync);
+BIND(Batch);
+BIND(GetCoalescedUpdates);
+BIND(BulkUpdate);
+BIND(StringRelease);
+
+template<typename Reply>
+struct ReplyWriter
+{
+	template<typename H, typename Args, size_t ...I>
+	static void invoke(Serializer& serializerOut, Args& args, IndexList<I...>)
+	{
+		serializerOut << H::invoke(std::get<I>(args)...);
+	}
+};
+
+template<>
+struct ReplyWriter<void>
+{
+	template<typename H, typename Args, size_t ...I>
+	static void invoke(Serializer&, Args& args, IndexList<I...>)
+	{
+		H::invoke(std::get<I>(args)...);
+	}
+};
+
+// Messages whose first argument is an object id
+template<PipeMessages M> struct IsObjectMessage : IsSetter<M> {};
+template<> struct IsObjectMessage<PipeMessages::TextUpdate> : std::true_type {};
+template<> struct IsObjectMessage<PipeMessages::TextUpdateInterned> : std::true_type {};
+
+// One of a fixed set of mutexes, objects with different ids rarely share one
+std::mutex& objectMutex(int id);
+
+// Held while a handler runs. Messages on the same object are applied one at a time and in the
+// order they were dispatched, everything else relies on the Renderer's own locking.
+template<bool ObjectMessage>
+struct MessageLock
+{
+	template<typename Args>
+	MessageLock(const Args&)
+	{
+	}
+};
+
+template<>
+struct MessageLock<true>
+{
+	template<typename Args>
+	MessageLock(const Args& args) : m_lock(objectMutex(std::get<0>(args)))
+	{
+	}
+
+	std::lock_guard<std::mutex> m_lock;
+};
+
+// Decodes the payload of M (the message id has already been read) and writes the handler's reply.
+// Decoding runs concurrently on the transport's threads, only applying the message is serialized.
+template<PipeMessages M>
+void dispatchMessage(Serializer& serializerIn, Serializer& serializerOut)
+{
+	static_assert(MessageHandler<M>::defined, "PipeMessages entry has no handler, add a BIND() line");
+
+	typedef MessageSchema<M> Schema;
+	typedef typename Schema::Args Args;
+
+	Args args;
+	decodeMessage<M>(serializerIn, args);
+
+	MessageLock<IsObjectMessage<M>::value> lock(args);
+
+	ReplyWriter<typename Schema::Reply>::template invoke<MessageHandler<M> >(serializerOut, args,
+		typename MakeIndexList<std::tuple_size<Args>::value>::type());
+}
+
+typedef void (*MessageDispatcher)(Serializer& serializerIn, Serializer& serializerOut);
+
+template<size_t M, bool Dispatched>
+struct MessageSlot
+{
+	static void dispatch(Serializer& serializerIn, Serializer& serializerOut)
+	{
+		dispatchMessage<(PipeMessages) M>(serializerIn, serializerOut);
+	}
+};
+
+// Never called, the table holds nullptr instead
+template<size_t M>
+struct MessageSlot<M, false>
+{
+	static void dispatch(Serializer&, Serializer&)
+	{
+	}
+};
+
+// Handlers indexed by their PipeMessages value, for every message or only the setters. The table only
+// holds address constants, so it is built by the compiler; a message without handler fails to compile.
+template<bool SettersOnly = false, typename Indices = typename MakeIndexList<size_t(PipeMessages::Count)>::type>
+struct MessageTable;
+
+template<bool SettersOnly, size_t ...M>
+struct MessageTable<SettersOnly, IndexList<M...> >
+{
+	// nullptr for ids outside the table
+	static MessageDispatcher find(PipeMessages eMessage)
+	{
+		unsigned short index = (unsigned short) eMessage;
+		return index < sizeof...(M) ? handlers[index] : nullptr;
+	}
+
+private:
+	template<size_t I>
+	struct Slot
+	{
+		enum { dispatched = I != 0 && !IsReserved<(PipeMessages) I>::value && (!SettersOnly || IsSetter<(PipeMessages) I>::value) };
+	};
+
+	static const MessageDispatcher handlers[sizeof...(M)];
+};
+
+template<bool SettersOnly, size_t ...M>
+const MessageDispatcher MessageTable<SettersOnly, IndexList<M...> >::handlers[sizeof...(M)] =
+{
+	(Slot<M>::dispatched ? &MessageSlot<M, Slot<M>::dispatched != 0>::dispatch : nullptr)...
+};
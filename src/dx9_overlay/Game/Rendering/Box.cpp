@@ -1,7 +1,7 @@
 #include "Box.h"
 #include "dx_utils.h"
 
-Box::Box(Renderer *renderer,  int x, int y, int w, int h, D3DCOLOR color, bool show)
+Box::Box(Renderer *renderer,  int x, int y, int w, int h, unsigned int color, bool show)
 	: RenderBase(renderer), m_bShown(false)
 {
 	setPos(x, y);
@@ -21,27 +21,27 @@ void Box::setPos(int x,int y)
 	m_iX = x, m_iY = y;
 }
 
-void Box::setBorderColor(D3DCOLOR dwColor)
+void Box::setBorderColor(unsigned int dwColor)
 {
 	m_dwBorderColor = dwColor;
 }
 
-void Box::setBoxColor(D3DCOLOR dwColor)
+void Box::setBoxColor(unsigned int dwColor)
 {
 	m_dwBoxColor = dwColor;
 }
 
-void Box::setBorderWidth(DWORD dwWidth)
+void Box::setBorderWidth(unsigned int dwWidth)
 {
 	m_dwBorderWidth = dwWidth;
 }
 
-void Box::setBoxWidth(DWORD dwWidth)
+void Box::setBoxWidth(unsigned int dwWidth)
 {
 	m_dwBoxWidth = dwWidth;
 }
 
-void Box::setBoxHeight(DWORD dwHeight)
+void Box::setBoxHeight(unsigned int dwHeight)
 {
 	m_dwBoxHeight = dwHeight;
 }
@@ -56,12 +56,79 @@ void Box::setShown(bool b)
 	m_bShown = b;
 }
 
-void Box::draw(IDirect3DDevice9 *pDevice)
+bool Box::hasProperty(OverlayProperty property) const
 {
-	if(!m_bShown)
+	switch (property)
+	{
+	case PropertyShown:
+	case PropertyX:
+	case PropertyY:
+	case PropertyWidth:
+	case PropertyHeight:
+	case PropertyColor:
+	case PropertyBorderShown:
+	case PropertyBorderWidth:
+	case PropertyBorderColor:
+		return true;
+
+	default:
+		return RenderBase::hasProperty(property);
+	}
+}
+
+bool Box::setProperty(OverlayProperty property, int value)
+{
+	switch (property)
+	{
+	case PropertyShown:
+		setShown(value != 0);
+		break;
+
+	case PropertyX:
+		m_iX = value;
+		break;
+
+	case PropertyY:
+		m_iY = value;
+		break;
+
+	case PropertyWidth:
+		setBoxWidth((unsigned int) value);
+		break;
+
+	case PropertyHeight:
+		setBoxHeight((unsigned int) value);
+		break;
+
+	case PropertyColor:
+		setBoxColor((unsigned int) value);
+		break;
+
+	case PropertyBorderShown:
+		setBorderShown(value != 0);
+		break;
+
+	case PropertyBorderWidth:
+		setBorderWidth((unsigned int) value);
+		break;
+
+	case PropertyBorderColor:
+		setBorderColor((unsigned int) value);
+		break;
+
+	default:
+		return RenderBase::setProperty(property, value);
+	}
+
+	return true;
+}
+
+void Box::draw(OverlayDevice *pDevice)
+{
+	if(!m_bShown || m_renderStates == nullptr)
 		return;
 
-	m_renderStates->BeginDraw(pDevice);
+	m_renderStates->begin();
 
 	float x = (float)calculatedXPos(m_iX);
 	float y = (float)calculatedYPos(m_iY);
@@ -73,10 +140,10 @@ void Box::draw(IDirect3DDevice9 *pDevice)
 	if(m_bBorderShown)
 		Drawing::DrawRectangular(x, y, w, h, (float)m_dwBorderWidth, m_dwBorderColor, pDevice);
 
-	m_renderStates->EndDraw(pDevice);
+	m_renderStates->end();
 }
 
-void Box::reset(IDirect3DDevice9 *pDevice)
+void Box::reset(OverlayDevice *)
 {
 	m_renderStates.reset();
 }
@@ -91,7 +158,7 @@ void Box::hide()
 	setShown(false);
 }
 
-void Box::releaseResourcesForDeletion(IDirect3DDevice9 *pDevice)
+void Box::releaseResourcesForDeletion(OverlayDevice *)
 {
 	m_bShown = false;
 	m_bBorderShown = false;
@@ -104,13 +171,13 @@ bool Box::canBeDeleted()
 	return true;
 }
 
-bool Box::loadResource(IDirect3DDevice9 *pDevice)
+bool Box::loadResource(OverlayDevice *pDevice)
 {
-	m_renderStates = std::make_unique<RenderStates>(pDevice);
-	return true;
+	m_renderStates = pDevice->createStates();
+	return m_renderStates != nullptr;
 }
 
-void Box::firstDrawAfterReset(IDirect3DDevice9 *pDevice)
+bool Box::firstDrawAfterReset(OverlayDevice *pDevice)
 {
-	loadResource(pDevice);
+	return loadResource(pDevice);
 }
\ No newline at end of file
@@ -1,41 +1,41 @@
 #pragma once
-#include <d3dx9.h>
-
 #include "RenderBase.h"
-#include "RenderStates.h"
 
 class Box : public RenderBase
 {
 public:
-	Box(Renderer *renderer, int x, int y, int w, int h, D3DCOLOR color, bool show);
+	Box(Renderer *renderer, int x, int y, int w, int h, unsigned int color, bool show);
 
 	void setPos(int x,int y);
-	void setBorderColor(D3DCOLOR dwColor);
-	void setBoxColor(D3DCOLOR dwColor);
-	void setBorderWidth(DWORD dwWidth);
-	void setBoxWidth(DWORD dwWidth);
-	void setBoxHeight(DWORD dwHeight);
+	void setBorderColor(unsigned int dwColor);
+	void setBoxColor(unsigned int dwColor);
+	void setBorderWidth(unsigned int dwWidth);
+	void setBoxWidth(unsigned int dwWidth);
+	void setBoxHeight(unsigned int dwHeight);
 	void setBorderShown(bool b);
 	void setShown(bool b);
 
+	virtual bool setProperty(OverlayProperty property, int value) override final;
+	virtual bool hasProperty(OverlayProperty property) const override final;
+
 protected:
-	virtual void draw(IDirect3DDevice9 *pDevice) sealed;
-	virtual void reset(IDirect3DDevice9 *pDevice) sealed;
+	virtual void draw(OverlayDevice *pDevice) final;
+	virtual void reset(OverlayDevice *pDevice) final;
 
-	virtual void show() sealed;
-	virtual void hide() sealed;
+	virtual void show() final;
+	virtual void hide() final;
 
-	virtual void releaseResourcesForDeletion(IDirect3DDevice9 *pDevice) sealed;
-	virtual bool canBeDeleted() sealed;
+	virtual void releaseResourcesForDeletion(OverlayDevice *pDevice) final;
+	virtual bool canBeDeleted() final;
 
-	virtual bool loadResource(IDirect3DDevice9 *pDevice) override sealed;
-	virtual void firstDrawAfterReset(IDirect3DDevice9 *pDevice) override sealed;
+	virtual bool loadResource(OverlayDevice *pDevice) override final;
+	virtual bool firstDrawAfterReset(OverlayDevice *pDevice) override final;
 
 private:
 	bool m_bShown, m_bBorderShown;
-	D3DCOLOR m_dwBoxColor, m_dwBorderColor;
-	DWORD m_dwBorderWidth, m_dwBoxWidth, m_dwBoxHeight;
+	unsigned int m_dwBoxColor, m_dwBorderColor;
+	unsigned int m_dwBorderWidth, m_dwBoxWidth, m_dwBoxHeight;
 	int	m_iX, m_iY;
 
-	std::unique_ptr<RenderStates> m_renderStates;
+	std::unique_ptr<OverlayStates> m_renderStates;
 };
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include <Utils/Utf8.h>
+
+#include "D3D9Device.h"
+#include "D3DFont.h"
+#include "RenderStates.h"
+
+#define DRAW_FVF (D3DFVF_XYZRHW | D3DFVF_DIFFUSE | D3DFVF_TEX1)
+
+class D3D9Texture : public OverlayTexture
+{
+public:
+	explicit D3D9Texture(LPDIRECT3DTEXTURE9 pTexture) : m_pTexture(pTexture)
+	{
+		m_pTexture->GetLevelDesc(0, &m_desc);
+	}
+
+	~D3D9Texture()
+	{
+		m_pTexture->Release();
+	}
+
+	virtual int width() const override
+	{
+		return (int) m_desc.Width;
+	}
+
+	virtual int height() const override
+	{
+		return (int) m_desc.Height;
+	}
+
+	LPDIRECT3DTEXTURE9 texture() const
+	{
+		return m_pTexture;
+	}
+
+private:
+	LPDIRECT3DTEXTURE9 m_pTexture;
+	D3DSURFACE_DESC m_desc;
+};
+
+class D3D9Sprite : public OverlaySprite
+{
+public:
+	explicit D3D9Sprite(LPD3DXSPRITE pSprite) : m_pSprite(pSprite)
+	{
+	}
+
+	~D3D9Sprite()
+	{
+		m_pSprite->Release();
+	}
+
+	virtual void draw(OverlayTexture *texture, int x, int y, int rotation, int align, float scaleX, float scaleY) override
+	{
+		if (texture == nullptr)
+			return;
+
+		D3DXVECTOR3 Vec;
+
+		Vec.x = (FLOAT) x;
+		Vec.y = (FLOAT) y;
+		Vec.z = (FLOAT)0.0f;
+
+		D3DXMATRIX mat;
+		D3DXVECTOR2 scaling(scaleX, scaleY);
+
+		D3DXVECTOR2 spriteCentre;
+		if (align == 1)
+			spriteCentre = D3DXVECTOR2((FLOAT) texture->width() / 2, (FLOAT) texture->height() / 2);
+		else
+			spriteCentre = D3DXVECTOR2(0, 0);
+
+		D3DXVECTOR2 trans = D3DXVECTOR2(0, 0);
+		D3DXMatrixTransformation2D(&mat, NULL, 0.0, &scaling, &spriteCentre, (FLOAT) rotation, &trans);
+
+		m_pSprite->SetTransform(&mat);
+		m_pSprite->Begin(D3DXSPRITE_ALPHABLEND);
+		m_pSprite->Draw(static_cast<D3D9Texture *>(texture)->texture(), NULL, NULL, &Vec, 0xFFFFFFFF);
+		m_pSprite->End();
+	}
+
+	virtual void reset() override
+	{
+		m_pSprite->OnLostDevice();
+		m_pSprite->OnResetDevice();
+	}
+
+private:
+	LPD3DXSPRITE m_pSprite;
+};
+
+class D3D9Line : public OverlayLine
+{
+public:
+	explicit D3D9Line(LPD3DXLINE pLine) : m_pLine(pLine)
+	{
+	}
+
+	~D3D9Line()
+	{
+		m_pLine->Release();
+	}
+
+	virtual void draw(float x1, float y1, float x2, float y2, float width, unsigned int color) override
+	{
+		D3DXVECTOR2	LinePos[2];
+
+		m_pLine->SetAntialias(TRUE);
+		m_pLine->SetWidth(width);
+
+		m_pLine->Begin();
+
+		LinePos[0].x = x1;
+		LinePos[0].y = y1;
+		LinePos[1].x = x2;
+		LinePos[1].y = y2;
+
+		m_pLine->Draw(LinePos, 2, color);
+		m_pLine->End();
+	}
+
+	virtual void reset() override
+	{
+		m_pLine->OnLostDevice();
+		m_pLine->OnResetDevice();
+	}
+
+private:
+	LPD3DXLINE m_pLine;
+};
+
+class D3D9Font : public OverlayFont
+{
+public:
+	D3D9Font(IDirect3DDevice9 *pDevice, const std::string& name, int height, unsigned int flags)
+		: m_font(utf8ToWide(name), height, flags)
+	{
+		m_font.InitDeviceObjects(pDevice);
+		m_font.RestoreDeviceObjects();
+	}
+
+	virtual void draw(float x, float y, unsigned int color, const std::string& text, unsigned int flags) override
+	{
+		m_font.DrawTextA(x, y, color, text.c_str(), flags);
+	}
+
+private:
+	CD3DFont m_font;
+};
+
+D3D9Device::D3D9Device(IDirect3DDevice9 *pDevice) : m_pDevice(pDevice)
+{
+}
+
+void D3D9Device::viewport(int& width, int& height)
+{
+	D3DVIEWPORT9 viewPort;
+	m_pDevice->GetViewport(&viewPort);
+
+	width = viewPort.Width;
+	height = viewPort.Height;
+}
+
+void D3D9Device::drawTriangleStrip(const OverlayVertex *vertices, unsigned int primitiveCount)
+{
+	DWORD dwOldFVF;
+	LPDIRECT3DPIXELSHADER9 ppixelShader;
+	LPDIRECT3DBASETEXTURE9 ppTexture;
+
+	m_pDevice->GetFVF(&dwOldFVF);
+	m_pDevice->GetPixelShader(&ppixelShader);
+	m_pDevice->GetTexture(0, &ppTexture);
+
+	m_pDevice->SetPixelShader(NULL);
+	m_pDevice->SetTexture(0, NULL);
+	m_pDevice->SetFVF(DRAW_FVF);
+
+	m_pDevice->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, primitiveCount, vertices, sizeof(OverlayVertex));
+
+	m_pDevice->SetPixelShader(ppixelShader);
+	m_pDevice->SetTexture(0, ppTexture);
+	m_pDevice->SetFVF(dwOldFVF);
+}
+
+std::unique_ptr<OverlayStates> D3D9Device::createStates()
+{
+	return std::unique_ptr<OverlayStates>(new RenderStates(m_pDevice));
+}
+
+std::unique_ptr<OverlayTexture> D3D9Device::createTexture(const std::string& path)
+{
+	LPDIRECT3DTEXTURE9 pTexture = NULL;
+	if (FAILED(D3DXCreateTextureFromFileW(m_pDevice, utf8ToWide(path).c_str(), &pTexture)) || pTexture == NULL)
+		return nullptr;
+
+	return std::unique_ptr<OverlayTexture>(new D3D9Texture(pTexture));
+}
+
+std::unique_ptr<OverlaySprite> D3D9Device::createSprite()
+{
+	LPD3DXSPRITE pSprite = NULL;
+	if (FAILED(D3DXCreateSprite(m_pDevice, &pSprite)) || pSprite == NULL)
+		return nullptr;
+
+	return std::unique_ptr<OverlaySprite>(new D3D9Sprite(pSprite));
+}
+
+std::unique_ptr<OverlayLine> D3D9Device::createLine()
+{
+	LPD3DXLINE pLine = NULL;
+	if (FAILED(D3DXCreateLine(m_pDevice, &pLine)) || pLine == NULL)
+		return nullptr;
+
+	return std::unique_ptr<OverlayLine>(new D3D9Line(pLine));
+}
+
+std::unique_ptr<OverlayFont> D3D9Device::createFont(const std::string& name, int height, unsigned int flags)
+{
+	return std::unique_ptr<OverlayFont>(new D3D9Font(m_pDevice, name, height, flags));
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <d3dx9.h>
+
+#include "OverlayDevice.h"
+
+// The game's device. Only wraps the pointer, so the hooks create one for every call.
+class D3D9Device : public OverlayDevice
+{
+public:
+	explicit D3D9Device(IDirect3DDevice9 *pDevice);
+
+	virtual void viewport(int& width, int& height) override;
+
+	virtual void drawTriangleStrip(const OverlayVertex *vertices, unsigned int primitiveCount) override;
+
+	virtual std::unique_ptr<OverlayStates> createStates() override;
+	virtual std::unique_ptr<OverlayTexture> createTexture(const std::string& path) override;
+	virtual std::unique_ptr<OverlaySprite> createSprite() override;
+	virtual std::unique_ptr<OverlayLine> createLine() override;
+	virtual std::unique_ptr<OverlayFont> createFont(const std::string& name, int height, unsigned int flags) override;
+
+private:
+	IDirect3DDevice9 *m_pDevice;
+};
@@ -11,6 +11,10 @@
 #include <d3dx9.h>
 #include "D3DFont.h"
 
+#include <Utils/Utf8.h>
+
+#include <boost/functional/hash.hpp>
+
 #define SAFE_RELEASE( p ) if( p ){ p->Release(); p = NULL; }
 
 
@@ -39,50 +43,77 @@ inline FONT3DVERTEX InitFont3DVertex(const D3DXVECTOR3& p, const D3DXVECTOR3& n,
 	return v;
 }
 
-std::vector<std::shared_ptr<SharedFont>> CD3DFont::sharedFonts = std::vector<std::shared_ptr<SharedFont>>();
-
-std::shared_ptr<SharedFont> CD3DFont::GetFont(const std::wstring & fontName, DWORD dwHeight, DWORD dwFlags)
+//-----------------------------------------------------------------------------
+// Name: ParseColorTag()
+// Desc: Matches a {RRGGBB} color tag (up to 8 hex digits) at 'it' and returns
+//       the position behind it, or NULL if there is no valid tag.
+//       The tag is plain ASCII, so it can be matched on the UTF-8 bytes.
+//-----------------------------------------------------------------------------
+static const char *ParseColorTag(const char *it, const char *end, DWORD& color)
 {
-	std::shared_ptr<SharedFont> font;
-	for (size_t i = 0; i < sharedFonts.size(); i++)
+	DWORD value = 0;
+	int digits = 0;
+
+	for (const char *p = it + 1; p < end; p++)
 	{
-		auto tempFont = sharedFonts.at(i);
+		char ch = (char) toupper((unsigned char) *p);
 
-		// Check for existing font
-		if (tempFont != nullptr && tempFont->Compare(fontName, dwHeight, dwFlags))
+		if (ch == '}')
 		{
-			font = tempFont;
-			break;
+			if (digits > 0)
+				color = value;
+
+			return p + 1;
 		}
+
+		if (++digits > 8)
+			return NULL;
+
+		if (ch >= '0' && ch <= '9')
+			value = (value << 4) | (ch - '0');
+		else if (ch >= 'A' && ch <= 'F')
+			value = (value << 4) | (ch - 'A' + 10);
+		else
+			return NULL;
 	}
 
+	return NULL;
+}
+
+bool CD3DFont::FontKey::operator==(const FontKey& other) const
+{
+	return fontName == other.fontName && dwHeight == other.dwHeight && dwFlags == other.dwFlags;
+}
+
+size_t CD3DFont::FontKeyHash::operator()(const FontKey& key) const
+{
+	size_t seed = boost::hash_range(key.fontName.begin(), key.fontName.end());
+	boost::hash_combine(seed, key.dwHeight);
+	boost::hash_combine(seed, key.dwFlags);
+
+	return seed;
+}
+
+std::unordered_map<CD3DFont::FontKey, std::shared_ptr<SharedFont>, CD3DFont::FontKeyHash> CD3DFont::sharedFonts;
+
+std::shared_ptr<SharedFont> CD3DFont::GetFont(const FontKey& key)
+{
+	auto& font = sharedFonts[key];
+
 	// Create new font
 	if (font == nullptr)
-	{
-
-		font = std::make_shared<SharedFont>(fontName, dwHeight, dwFlags);
-		sharedFonts.push_back(font);
-	}
+		font = std::make_shared<SharedFont>(key.fontName, key.dwHeight, key.dwFlags);
 
 	font->AddReference();
 
 	return font;
 }
 
-void CD3DFont::ReleaseFont(std::shared_ptr<SharedFont> font)
+void CD3DFont::ReleaseFont(const FontKey& key)
 {
-	for (size_t i = 0; i < sharedFonts.size(); i++)
-	{
-		auto tempFont = sharedFonts.at(i);
-
-		if (font == tempFont)
-		{
-			if (font->RemoveReference())
-				sharedFonts.erase(sharedFonts.begin() + i);
-
-			break;
-		}
-	}
+	auto it = sharedFonts.find(key);
+	if (it != sharedFonts.end() && it->second->RemoveReference())
+		sharedFonts.erase(it);
 }
 
 //-----------------------------------------------------------------------------
@@ -97,7 +128,11 @@ CD3DFont::CD3DFont(const std::wstring &fontName, DWORD dwHeight, DWORD dwFlags)
 	m_pStateBlockSaved = NULL;
 	m_pStateBlockDrawText = NULL;
 
-	m_font = GetFont(fontName, dwHeight, dwFlags);
+	m_fontKey.fontName = fontName;
+	m_fontKey.dwHeight = dwHeight;
+	m_fontKey.dwFlags = dwFlags;
+
+	m_font = GetFont(m_fontKey);
 	m_dwFlags = dwFlags;
 }
 
@@ -223,7 +258,7 @@ HRESULT CD3DFont::DeleteDeviceObjects()
 {
 	if (m_font)
 	{
-		ReleaseFont(m_font);
+		ReleaseFont(m_fontKey);
 		m_font = nullptr;
 	}
 
@@ -239,7 +274,7 @@ HRESULT CD3DFont::DeleteDeviceObjects()
 // Name: GetTextExtent()
 // Desc: Get the dimensions of a text string
 //-----------------------------------------------------------------------------
-HRESULT CD3DFont::GetTextExtent(const WCHAR* strText, SIZE* pSize)
+HRESULT CD3DFont::GetTextExtent(const char* strText, SIZE* pSize)
 {
 	if (m_pd3dDevice == NULL || NULL == strText || NULL == pSize || m_font == nullptr)
 		return E_FAIL;
@@ -251,52 +286,23 @@ HRESULT CD3DFont::GetTextExtent(const WCHAR* strText, SIZE* pSize)
 	float width = 0.0f;
 	float height = rowHeight;
 
-	auto stringLength = lstrlenW(strText);
+	const char *it = strText, *end = strText + strlen(strText);
 
-	for (int i = 0; i < stringLength; i++)
+	while (it < end)
 	{
-		wchar_t c = strText[i];
-
-		if (c == L'{')
+		if (*it == '{')
 		{
-			int endIndex = 0;
-			bool valid = true;
-			std::wstring numericString = L"";
-			for (int j = i + 1; j < stringLength; j++)
-			{
-				wchar_t ch = strText[j];
-				ch = towupper(ch);
-
-				if (ch == '}')
-				{
-					endIndex = j;
-					break;
-				}
-
-				bool numeric = (ch >= L'0' && ch <= L'9') || (ch >= L'A' && ch <= L'F');
-				if (!numeric)
-				{
-					valid = false;
-					break;
-				}
-				else
-				{
-					numericString += ch;
-					if (numericString.size() > 8)
-					{
-						valid = false;
-						break;
-					}
-				}
-			}
-
-			if (endIndex > 0 && valid)
+			DWORD tagColor;
+			const char *tagEnd = ParseColorTag(it, end, tagColor);
+			if (tagEnd != NULL)
 			{
-				i = endIndex;
+				it = tagEnd;
 				continue;
 			}
 		}
 
+		unsigned int c = utf8Decode(it, end);
+
 		if (c == '\n')
 		{
 			rowWidth = 0.0f;
@@ -304,7 +310,7 @@ HRESULT CD3DFont::GetTextExtent(const WCHAR* strText, SIZE* pSize)
 			continue;
 		}
 
-		if (c < 0 || c > USHRT_MAX)
+		if (c > USHRT_MAX)
 			continue;
 
 		auto characterTexture = m_font->GetCharacterTexture(m_pd3dDevice, c);
@@ -330,7 +336,7 @@ HRESULT CD3DFont::GetTextExtent(const WCHAR* strText, SIZE* pSize)
 // Desc: Draws 2D text. Note that sx and sy are in pixels
 //-----------------------------------------------------------------------------
 HRESULT CD3DFont::DrawText(FLOAT sx, FLOAT sy, DWORD dwColor,
-	const WCHAR* strText, DWORD dwFlags)
+	const char* strText, DWORD dwFlags)
 {
 	if (m_pd3dDevice == NULL || strText == NULL || m_font == nullptr)
 		return E_FAIL;
@@ -357,57 +363,28 @@ HRESULT CD3DFont::DrawText(FLOAT sx, FLOAT sy, DWORD dwColor,
 	int trianglesCount = 0;
 	m_pVB->Lock(0, 0, (void**)&vertices, D3DLOCK_DISCARD);
 
-	auto stringLength = lstrlenW(strText);
+	const char *it = strText, *end = strText + strlen(strText);
 	DWORD customColor = dwColor;
 
-	auto textures = std::vector<LPDIRECT3DTEXTURE9>();
+	// Reused between calls, drawing a string doesn't allocate once it has seen its longest text
+	auto& textures = m_textures;
+	textures.clear();
 
-	for (int i = 0; i < stringLength; i++)
+	while (it < end)
 	{
-		wchar_t c = strText[i];
-
-		if (c == L'{')
+		if (*it == '{')
 		{
-			int endIndex = 0;
-			bool valid = true;
-			std::wstring numericString = L"";
-			for (int j = i + 1; j < stringLength; j++)
-			{
-				wchar_t ch = strText[j];
-				ch = towupper(ch);
-
-				if (ch == '}')
-				{
-					endIndex = j;
-					break;
-				}
-
-				bool numeric = (ch >= L'0' && ch <= L'9') || (ch >= L'A' && ch <= L'F');
-				if (!numeric)
-				{
-					valid = false;
-					break;
-				}
-				else
-				{
-					numericString += ch;
-					if (numericString.size() > 8)
-					{
-						valid = false;
-						break;
-					}
-				}
-			}
-
-			if (endIndex > 0 && valid)
+			const char *tagEnd = ParseColorTag(it, end, customColor);
+			if (tagEnd != NULL)
 			{
-				swscanf_s(numericString.data(), L"%X", &customColor);
 				customColor |= (dwColor >> 24) << 24;
-				i = endIndex;
+				it = tagEnd;
 				continue;
 			}
 		}
 
+		// Glyphs are looked up by code point, decoded straight from the UTF-8 text
+		unsigned int c = utf8Decode(it, end);
 
 		if (c == '\n')
 		{
@@ -416,7 +393,7 @@ HRESULT CD3DFont::DrawText(FLOAT sx, FLOAT sy, DWORD dwColor,
 			continue;
 		}
 
-		if (c < 0 || c > USHRT_MAX)
+		if (c > USHRT_MAX)
 			continue;
 
 		auto characterTexture = m_font->GetCharacterTexture(m_pd3dDevice, c);
@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 #include "SharedFont.h"
 
@@ -36,10 +37,25 @@
 //-----------------------------------------------------------------------------
 class CD3DFont
 {
-	static std::vector<std::shared_ptr<SharedFont>> sharedFonts;
+	// Identifies a SharedFont, equal keys share the same glyph textures
+	struct FontKey
+	{
+		std::wstring fontName;
+		DWORD dwHeight;
+		DWORD dwFlags;
 
-	static std::shared_ptr<SharedFont> GetFont(const std::wstring &fontName, DWORD dwHeight, DWORD dwFlags);
-	static void ReleaseFont(std::shared_ptr<SharedFont> font);
+		bool operator==(const FontKey& other) const;
+	};
+
+	struct FontKeyHash
+	{
+		size_t operator()(const FontKey& key) const;
+	};
+
+	static std::unordered_map<FontKey, std::shared_ptr<SharedFont>, FontKeyHash> sharedFonts;
+
+	static std::shared_ptr<SharedFont> GetFont(const FontKey& key);
+	static void ReleaseFont(const FontKey& key);
 
 	LPDIRECT3DDEVICE9       m_pd3dDevice; // A D3DDevice used for rendering
 	LPDIRECT3DVERTEXBUFFER9 m_pVB;        // VertexBuffer for rendering text
@@ -49,13 +65,16 @@ class CD3DFont
 	LPDIRECT3DSTATEBLOCK9 m_pStateBlockDrawText;
 
 	std::shared_ptr<SharedFont> m_font;
+	FontKey m_fontKey;
 	DWORD m_dwFlags;
+
+	std::vector<LPDIRECT3DTEXTURE9> m_textures;
 public:
-	// 2D and 3D text drawing functions
-	HRESULT DrawText(FLOAT x, FLOAT y, DWORD dwColor, const WCHAR* strText, DWORD dwFlags = 0L);
+	// 2D and 3D text drawing functions, strText is UTF-8
+	HRESULT DrawText(FLOAT x, FLOAT y, DWORD dwColor, const char* strText, DWORD dwFlags = 0L);
 
 	// Function to get extent of text
-	HRESULT GetTextExtent(const WCHAR* strText, SIZE* pSize);
+	HRESULT GetTextExtent(const char* strText, SIZE* pSize);
 
 	// Initializing and destroying device-dependent objects
 	HRESULT InitDeviceObjects(LPDIRECT3DDEVICE9 pd3dDevice);
@@ -1,8 +1,7 @@
 #include "Image.h"
-#include "dx_utils.h"
 
 Image::Image(Renderer *renderer, const std::string& file_path, int x, int y, int rotation, int align, bool bShow)
-	: RenderBase(renderer), m_pSprite(NULL), m_pTexture(NULL)
+	: RenderBase(renderer)
 {
 	setFilePath(file_path);
 	setPos(x, y);
@@ -49,7 +48,54 @@ bool Image::updateImage(const std::string& file_path, int x, int y, int rotation
 	return true;
 }
 
-void Image::draw(IDirect3DDevice9 *pDevice)
+bool Image::hasProperty(OverlayProperty property) const
+{
+	switch (property)
+	{
+	case PropertyShown:
+	case PropertyX:
+	case PropertyY:
+	case PropertyRotation:
+	case PropertyAlign:
+		return true;
+
+	default:
+		return RenderBase::hasProperty(property);
+	}
+}
+
+bool Image::setProperty(OverlayProperty property, int value)
+{
+	switch (property)
+	{
+	case PropertyShown:
+		setShown(value != 0);
+		break;
+
+	case PropertyX:
+		m_x = value;
+		break;
+
+	case PropertyY:
+		m_y = value;
+		break;
+
+	case PropertyRotation:
+		setRotation(value);
+		break;
+
+	case PropertyAlign:
+		setAlign(value);
+		break;
+
+	default:
+		return RenderBase::setProperty(property, value);
+	}
+
+	return true;
+}
+
+void Image::draw(OverlayDevice *)
 {
 	if(!m_bShow)
 		return;
@@ -59,17 +105,14 @@ void Image::draw(IDirect3DDevice9 *pDevice)
 	float sX = scaleX();
 	float sY = scaleY();
 
-	if(m_pTexture && m_pSprite)
-		Drawing::DrawSprite(m_pSprite, m_pTexture, x, y, m_rotation, m_align, sX, sY);
+	if(m_texture && m_sprite)
+		m_sprite->draw(m_texture.get(), x, y, m_rotation, m_align, sX, sY);
 }
 
-void Image::reset(IDirect3DDevice9 *pDevice)
+void Image::reset(OverlayDevice *)
 {
-	if(m_pSprite)
-	{
-		m_pSprite->OnLostDevice();
-		m_pSprite->OnResetDevice();
-	}
+	if(m_sprite)
+		m_sprite->reset();
 }
 
 
@@ -84,47 +127,30 @@ void Image::hide()
 }
 
 
-void Image::releaseResourcesForDeletion(IDirect3DDevice9 *pDevice)
+void Image::releaseResourcesForDeletion(OverlayDevice *)
 {
-	if(m_pSprite)
-	{
-		m_pSprite->Release();
-		m_pSprite = NULL;
-	}
-
-	if(m_pTexture)
-	{
-		m_pTexture->Release();
-		m_pTexture = NULL;
-	}
+	m_sprite.reset();
+	m_texture.reset();
 }
 
 bool Image::canBeDeleted()
 {
-	return (m_pTexture == NULL && m_pSprite == NULL);
+	return (m_texture == nullptr && m_sprite == nullptr);
 }
 
-bool Image::loadResource(IDirect3DDevice9 *pDevice)
+bool Image::loadResource(OverlayDevice *pDevice)
 {
-	if(m_pSprite)
-	{
-		m_pSprite->Release();
-		m_pSprite = NULL;
-	}
+	m_sprite.reset();
+	m_texture.reset();
 
-	if(m_pTexture)
-	{
-		m_pTexture->Release();
-		m_pTexture = NULL;
-	}
+	m_texture = pDevice->createTexture(m_filePath);
+	m_sprite = pDevice->createSprite();
 
-	D3DXCreateTextureFromFileA(pDevice, m_filePath.c_str(), &m_pTexture);
-	D3DXCreateSprite(pDevice, &m_pSprite);
-
-	return (m_pTexture != NULL && m_pSprite != NULL);
+	return (m_texture != nullptr && m_sprite != nullptr);
 }
 
-void Image::firstDrawAfterReset(IDirect3DDevice9 *pDevice)
+bool Image::firstDrawAfterReset(OverlayDevice *)
 {
-
+	// The sprite restores itself in reset()
+	return true;
 }
\ No newline at end of file
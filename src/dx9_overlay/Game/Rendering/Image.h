@@ -1,13 +1,11 @@
 #pragma once
-#include <d3dx9.h>
+#include <string>
 
 #include "RenderBase.h"
 
 class Image : public RenderBase
 {
 public:
-	static void DrawSprite(LPD3DXSPRITE SpriteInterface, LPDIRECT3DTEXTURE9 TextureInterface, int PosX, int PosY, int Rotation, int Align);
-
 	Image(Renderer *renderer, const std::string& file_path, int x, int y, int rotation, int align, bool bShow);
 
 	void setFilePath(const std::string & path);
@@ -17,18 +15,21 @@ public:
 	void setShown(bool show);
 	bool updateImage(const std::string& file_path, int x, int y, int rotation, int align, bool bShow);
 
+	virtual bool setProperty(OverlayProperty property, int value) override final;
+	virtual bool hasProperty(OverlayProperty property) const override final;
+
 protected:
-	virtual void draw(IDirect3DDevice9 *pDevice) sealed;
-	virtual void reset(IDirect3DDevice9 *pDevice) sealed;
+	virtual void draw(OverlayDevice *pDevice) final;
+	virtual void reset(OverlayDevice *pDevice) final;
 
-	virtual void show() sealed;
-	virtual void hide() sealed;
+	virtual void show() final;
+	virtual void hide() final;
 
-	virtual void releaseResourcesForDeletion(IDirect3DDevice9 *pDevice) sealed;
-	virtual bool canBeDeleted() sealed;
+	virtual void releaseResourcesForDeletion(OverlayDevice *pDevice) final;
+	virtual bool canBeDeleted() final;
 
-	virtual bool loadResource(IDirect3DDevice9 *pDevice) override sealed;
-	virtual void firstDrawAfterReset(IDirect3DDevice9 *pDevice) override sealed;
+	virtual bool loadResource(OverlayDevice *pDevice) override final;
+	virtual bool firstDrawAfterReset(OverlayDevice *pDevice) override final;
 
 private:
 	std::string			m_filePath;
@@ -37,6 +38,6 @@ private:
 
 	bool m_bShow;
 
-	LPDIRECT3DTEXTURE9 m_pTexture;
-	LPD3DXSPRITE m_pSprite;
+	std::unique_ptr<OverlayTexture> m_texture;
+	std::unique_ptr<OverlaySprite> m_sprite;
 };
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include "Line.h"
 
-Line::Line(Renderer *renderer, int x1,int y1,int x2,int y2,int width,D3DCOLOR color, bool bShow)
-	: RenderBase(renderer), m_Line(NULL)
+Line::Line(Renderer *renderer, int x1,int y1,int x2,int y2,int width,unsigned int color, bool bShow)
+	: RenderBase(renderer)
 {
 	setPos(x1,y1,x2,y2);
 	setWidth(width);
@@ -20,7 +20,7 @@ void Line::setWidth(int width)
 	m_Width = width;
 }
 
-void Line::setColor(D3DCOLOR color)
+void Line::setColor(unsigned int color)
 {
 	m_Color = color;
 }
@@ -30,38 +30,80 @@ void Line::setShown(bool show)
 	m_bShow = show;
 }
 
-void Line::draw(IDirect3DDevice9 *pDevice)
+bool Line::hasProperty(OverlayProperty property) const
 {
-	if(!m_bShow || m_Line == NULL)
-		return;
+	switch (property)
+	{
+	case PropertyShown:
+	case PropertyX:
+	case PropertyY:
+	case PropertyX2:
+	case PropertyY2:
+	case PropertyWidth:
+	case PropertyColor:
+		return true;
+
+	default:
+		return RenderBase::hasProperty(property);
+	}
+}
+
+bool Line::setProperty(OverlayProperty property, int value)
+{
+	switch (property)
+	{
+	case PropertyShown:
+		setShown(value != 0);
+		break;
 
-	D3DXVECTOR2	LinePos[2];
+	case PropertyX:
+		m_X1 = value;
+		break;
 
-	m_renderStates->BeginDraw(pDevice);
+	case PropertyY:
+		m_Y1 = value;
+		break;
 
-	m_Line->SetAntialias(TRUE);
-	m_Line->SetWidth((FLOAT)m_Width);
+	case PropertyX2:
+		m_X2 = value;
+		break;
 
-	m_Line->Begin();
+	case PropertyY2:
+		m_Y2 = value;
+		break;
 
-	LinePos[0].x = (float)calculatedXPos(m_X1);
-	LinePos[0].y = (float)calculatedYPos(m_Y1);
-	LinePos[1].x = (float)calculatedXPos(m_X2);
-	LinePos[1].y = (float)calculatedYPos(m_Y2);
+	case PropertyWidth:
+		setWidth(value);
+		break;
 
-	m_Line->Draw(LinePos,2,m_Color);
-	m_Line->End();
+	case PropertyColor:
+		setColor((unsigned int) value);
+		break;
 
-	m_renderStates->EndDraw(pDevice);
+	default:
+		return RenderBase::setProperty(property, value);
+	}
+
+	return true;
 }
 
-void Line::reset(IDirect3DDevice9 *pDevice)
+void Line::draw(OverlayDevice *)
+{
+	if(!m_bShow || m_Line == nullptr || m_renderStates == nullptr)
+		return;
+
+	m_renderStates->begin();
+
+	m_Line->draw((float)calculatedXPos(m_X1), (float)calculatedYPos(m_Y1),
+		(float)calculatedXPos(m_X2), (float)calculatedYPos(m_Y2), (float)m_Width, m_Color);
+
+	m_renderStates->end();
+}
+
+void Line::reset(OverlayDevice *)
 {
 	if(m_Line)
-	{
-		m_Line->OnLostDevice();
-		m_Line->OnResetDevice();
-	}
+		m_Line->reset();
 
 	m_renderStates.reset();
 }
@@ -76,38 +118,26 @@ void Line::hide()
 	setShown(false);
 }
 
-void Line::releaseResourcesForDeletion(IDirect3DDevice9 *pDevice)
+void Line::releaseResourcesForDeletion(OverlayDevice *)
 {
-	if(m_Line)
-	{
-		m_Line->Release();
-		m_Line = NULL;
-	}
-
+	m_Line.reset();
 	m_renderStates.reset();
 }
 
 bool Line::canBeDeleted()
 {
-	return (m_Line == NULL) ? true : false;
+	return (m_Line == nullptr) ? true : false;
 }
 
-bool Line::loadResource(IDirect3DDevice9 *pDevice)
+bool Line::loadResource(OverlayDevice *pDevice)
 {
-	if(m_Line)
-	{
-		m_Line->Release();
-		m_Line = NULL;
-	}
-
-	D3DXCreateLine(pDevice,&m_Line);
-
-	m_renderStates = std::make_unique<RenderStates>(pDevice);
+	m_Line = pDevice->createLine();
+	m_renderStates = pDevice->createStates();
 
-	return m_Line != NULL;
+	return m_Line != nullptr && m_renderStates != nullptr;
 }
 
-void Line::firstDrawAfterReset(IDirect3DDevice9 *pDevice)
+bool Line::firstDrawAfterReset(OverlayDevice *pDevice)
 {
-	loadResource(pDevice);
+	return loadResource(pDevice);
 }
\ No newline at end of file
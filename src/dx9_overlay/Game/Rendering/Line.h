@@ -1,39 +1,39 @@
 #pragma once
-#include <d3dx9.h>
-
 #include "RenderBase.h"
-#include "RenderStates.h"
 class Line : public RenderBase
 {
 public:
-	Line(Renderer *renderer, int x1,int y1,int x2,int y2,int width,D3DCOLOR color, bool bShow);
+	Line(Renderer *renderer, int x1,int y1,int x2,int y2,int width,unsigned int color, bool bShow);
 
 	void setPos(int x1,int y1,int x2,int y2);
 	void setWidth(int width);
-	void setColor(D3DCOLOR color);
+	void setColor(unsigned int color);
 	void setShown(bool show);
 
+	virtual bool setProperty(OverlayProperty property, int value) override final;
+	virtual bool hasProperty(OverlayProperty property) const override final;
+
 protected:
-	virtual void draw(IDirect3DDevice9 *pDevice) sealed;
-	virtual void reset(IDirect3DDevice9 *pDevice) sealed;
+	virtual void draw(OverlayDevice *pDevice) final;
+	virtual void reset(OverlayDevice *pDevice) final;
 
-	virtual void show() sealed;
-	virtual void hide() sealed;
+	virtual void show() final;
+	virtual void hide() final;
 
-	virtual void releaseResourcesForDeletion(IDirect3DDevice9 *pDevice) sealed;
-	virtual bool canBeDeleted() sealed;
+	virtual void releaseResourcesForDeletion(OverlayDevice *pDevice) final;
+	virtual bool canBeDeleted() final;
 
-	virtual bool loadResource(IDirect3DDevice9 *pDevice) override sealed;
-	virtual void firstDrawAfterReset(IDirect3DDevice9 *pDevice) override sealed;
+	virtual bool loadResource(OverlayDevice *pDevice) override final;
+	virtual bool firstDrawAfterReset(OverlayDevice *pDevice) override final;
 
 private:
 	int	m_X1, m_X2, m_Y1, m_Y2, m_Width;
 
 	bool m_bShow;
 
-	D3DCOLOR m_Color;
+	unsigned int m_Color;
 
-	LPD3DXLINE m_Line;
+	std::unique_ptr<OverlayLine> m_Line;
 
-	std::unique_ptr<RenderStates> m_renderStates;
+	std::unique_ptr<OverlayStates> m_renderStates;
 };
\ No newline at end of file
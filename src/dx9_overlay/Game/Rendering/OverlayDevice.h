@@ -0,0 +1,89 @@
+#pragma once
+#include <memory>
+#include <string>
+
+// Everything the Renderer and the render objects need from the graphics device. D3D9Device
+// forwards to the game's IDirect3DDevice9, RecordingDevice only counts the calls.
+//
+// Resources belong to the object which created them and are released with it. They stay
+// valid across a device reset, reset() restores what the device lost.
+
+// Font creation flags, the same values as D3DFONT_*
+#define OVERLAY_FONT_BOLD			0x0001
+#define OVERLAY_FONT_ITALIC			0x0002
+
+// Text drawing flags
+#define OVERLAY_TEXT_FILTERED		0x0008
+#define OVERLAY_TEXT_COLORTABLE		0x0020
+
+// Pretransformed vertex of the 2D primitives, positions are in pixels
+struct OverlayVertex
+{
+	float x, y, z, rhw;
+	unsigned int color;
+};
+
+// Render states of the overlay, begin() saves the game's and end() restores them
+class OverlayStates
+{
+public:
+	virtual ~OverlayStates() {}
+
+	virtual void begin() = 0;
+	virtual void end() = 0;
+};
+
+class OverlayTexture
+{
+public:
+	virtual ~OverlayTexture() {}
+
+	virtual int width() const = 0;
+	virtual int height() const = 0;
+};
+
+class OverlaySprite
+{
+public:
+	virtual ~OverlaySprite() {}
+
+	// Rotated around the texture's centre if align is 1, otherwise around its top left corner
+	virtual void draw(OverlayTexture *texture, int x, int y, int rotation, int align, float scaleX, float scaleY) = 0;
+	virtual void reset() = 0;
+};
+
+class OverlayLine
+{
+public:
+	virtual ~OverlayLine() {}
+
+	virtual void draw(float x1, float y1, float x2, float y2, float width, unsigned int color) = 0;
+	virtual void reset() = 0;
+};
+
+class OverlayFont
+{
+public:
+	virtual ~OverlayFont() {}
+
+	// text is UTF-8
+	virtual void draw(float x, float y, unsigned int color, const std::string& text, unsigned int flags) = 0;
+};
+
+class OverlayDevice
+{
+public:
+	virtual ~OverlayDevice() {}
+
+	virtual void viewport(int& width, int& height) = 0;
+
+	// Untextured triangles, the device's own shader, texture and vertex format are kept
+	virtual void drawTriangleStrip(const OverlayVertex *vertices, unsigned int primitiveCount) = 0;
+
+	// nullptr if the resource can't be created. Names and paths are UTF-8.
+	virtual std::unique_ptr<OverlayStates> createStates() = 0;
+	virtual std::unique_ptr<OverlayTexture> createTexture(const std::string& path) = 0;
+	virtual std::unique_ptr<OverlaySprite> createSprite() = 0;
+	virtual std::unique_ptr<OverlayLine> createLine() = 0;
+	virtual std::unique_ptr<OverlayFont> createFont(const std::string& name, int height, unsigned int flags) = 0;
+};
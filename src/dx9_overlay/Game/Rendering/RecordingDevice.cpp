@@ -0,0 +1,204 @@
+#include "RecordingDevice.h"
+
+// Base of the recorded resources, keeps resourcesAlive up to date
+class RecordedResource
+{
+public:
+	explicit RecordedResource(RecordingDevice::Counts& counts) : m_counts(counts)
+	{
+		m_counts.resourcesCreated++;
+		m_counts.resourcesAlive++;
+	}
+
+	~RecordedResource()
+	{
+		m_counts.resourcesAlive--;
+	}
+
+protected:
+	RecordingDevice::Counts& m_counts;
+
+private:
+	RecordedResource(const RecordedResource&);
+	RecordedResource& operator=(const RecordedResource&);
+};
+
+class RecordedStates : public OverlayStates, RecordedResource
+{
+public:
+	explicit RecordedStates(RecordingDevice::Counts& counts) : RecordedResource(counts)
+	{
+	}
+
+	virtual void begin() override
+	{
+		m_counts.stateChanges++;
+	}
+
+	virtual void end() override
+	{
+		m_counts.stateChanges++;
+	}
+};
+
+class RecordedTexture : public OverlayTexture, RecordedResource
+{
+public:
+	explicit RecordedTexture(RecordingDevice::Counts& counts) : RecordedResource(counts)
+	{
+	}
+
+	virtual int width() const override
+	{
+		return 64;
+	}
+
+	virtual int height() const override
+	{
+		return 64;
+	}
+};
+
+class RecordedSprite : public OverlaySprite, RecordedResource
+{
+public:
+	explicit RecordedSprite(RecordingDevice::Counts& counts) : RecordedResource(counts)
+	{
+	}
+
+	virtual void draw(OverlayTexture *texture, int, int, int, int, float, float) override
+	{
+		if (texture != nullptr)
+			m_counts.drawCalls++;
+	}
+
+	virtual void reset() override
+	{
+		m_counts.resets++;
+	}
+};
+
+class RecordedLine : public OverlayLine, RecordedResource
+{
+public:
+	explicit RecordedLine(RecordingDevice::Counts& counts) : RecordedResource(counts)
+	{
+	}
+
+	virtual void draw(float, float, float, float, float, unsigned int) override
+	{
+		m_counts.drawCalls++;
+	}
+
+	virtual void reset() override
+	{
+		m_counts.resets++;
+	}
+};
+
+class RecordedFont : public OverlayFont, RecordedResource
+{
+public:
+	explicit RecordedFont(RecordingDevice::Counts& counts) : RecordedResource(counts)
+	{
+	}
+
+	virtual void draw(float, float, unsigned int, const std::string&, unsigned int) override
+	{
+		m_counts.drawCalls++;
+	}
+};
+
+RecordingDevice::RecordingDevice(int width, int height) : m_width(width), m_height(height), m_bFailResources(false)
+{
+	m_counts.resourcesCreated = 0;
+	m_counts.resourcesAlive = 0;
+
+	clear();
+}
+
+void RecordingDevice::setViewport(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+}
+
+void RecordingDevice::setFailResources(bool bFail)
+{
+	m_bFailResources = bFail;
+}
+
+const RecordingDevice::Counts& RecordingDevice::counts() const
+{
+	return m_counts;
+}
+
+const std::vector<unsigned int>& RecordingDevice::stripColors() const
+{
+	return m_stripColors;
+}
+
+void RecordingDevice::clear()
+{
+	m_counts.drawCalls = 0;
+	m_counts.primitives = 0;
+	m_counts.stateChanges = 0;
+	m_counts.resets = 0;
+	m_counts.resourcesCreated = 0;
+
+	m_stripColors.clear();
+}
+
+void RecordingDevice::viewport(int& width, int& height)
+{
+	width = m_width;
+	height = m_height;
+}
+
+void RecordingDevice::drawTriangleStrip(const OverlayVertex *vertices, unsigned int primitiveCount)
+{
+	m_counts.drawCalls++;
+	m_counts.primitives += primitiveCount;
+
+	m_stripColors.push_back(vertices[0].color);
+}
+
+std::unique_ptr<OverlayStates> RecordingDevice::createStates()
+{
+	if (m_bFailResources)
+		return nullptr;
+
+	return std::unique_ptr<OverlayStates>(new RecordedStates(m_counts));
+}
+
+std::unique_ptr<OverlayTexture> RecordingDevice::createTexture(const std::string&)
+{
+	if (m_bFailResources)
+		return nullptr;
+
+	return std::unique_ptr<OverlayTexture>(new RecordedTexture(m_counts));
+}
+
+std::unique_ptr<OverlaySprite> RecordingDevice::createSprite()
+{
+	if (m_bFailResources)
+		return nullptr;
+
+	return std::unique_ptr<OverlaySprite>(new RecordedSprite(m_counts));
+}
+
+std::unique_ptr<OverlayLine> RecordingDevice::createLine()
+{
+	if (m_bFailResources)
+		return nullptr;
+
+	return std::unique_ptr<OverlayLine>(new RecordedLine(m_counts));
+}
+
+std::unique_ptr<OverlayFont> RecordingDevice::createFont(const std::string&, int, unsigned int)
+{
+	if (m_bFailResources)
+		return nullptr;
+
+	return std::unique_ptr<OverlayFont>(new RecordedFont(m_counts));
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "OverlayDevice.h"
+
+#include <vector>
+
+// OverlayDevice which draws nothing and only counts the calls, so the Renderer and the render
+// objects can run without Direct3D. It has to outlive the resources it created.
+class RecordingDevice : public OverlayDevice
+{
+public:
+	struct Counts
+	{
+		int drawCalls;			// triangle strips, sprites, lines and texts
+		int primitives;			// triangles of the strips
+		int stateChanges;		// begin() and end() of OverlayStates
+		int resets;				// reset() of sprites and lines
+		int resourcesCreated;
+		int resourcesAlive;
+	};
+
+	RecordingDevice(int width = 800, int height = 600);
+
+	void setViewport(int width, int height);
+
+	// Makes every following create...() fail, like a missing image file would
+	void setFailResources(bool bFail);
+
+	const Counts& counts() const;
+
+	// Color of the first vertex of every triangle strip, in the order they were drawn
+	const std::vector<unsigned int>& stripColors() const;
+
+	// Starts counting the next frame, resourcesAlive is kept
+	void clear();
+
+	virtual void viewport(int& width, int& height) override;
+
+	virtual void drawTriangleStrip(const OverlayVertex *vertices, unsigned int primitiveCount) override;
+
+	virtual std::unique_ptr<OverlayStates> createStates() override;
+	virtual std::unique_ptr<OverlayTexture> createTexture(const std::string& path) override;
+	virtual std::unique_ptr<OverlaySprite> createSprite() override;
+	virtual std::unique_ptr<OverlayLine> createLine() override;
+	virtual std::unique_ptr<OverlayFont> createFont(const std::string& name, int height, unsigned int flags) override;
+
+private:
+	int m_width, m_height;
+	bool m_bFailResources;
+
+	Counts m_counts;
+	std::vector<unsigned int> m_stripColors;
+};
@@ -4,7 +4,7 @@ int RenderBase::xCalculator = 800;
 int RenderBase::yCalculator = 600;
 
 RenderBase::RenderBase(Renderer *renderer)
-	: _renderer(renderer), _isMarkedForDeletion(false), _resourceChanged(false), _hasToBeInitialised(true), _firstDrawAfterReset(false)
+	: _hasToBeInitialised(true), _resourceChanged(false), _firstDrawAfterReset(false), _loadFailed(false), _isMarkedForDeletion(false), _renderer(renderer)
 {
 }
 
@@ -14,7 +14,11 @@ RenderBase::~RenderBase()
 
 void RenderBase::setPriority(int p)
 {
+	if (p == _priority)
+		return;
+
 	_priority = p;
+	_renderer->invalidateDrawOrder();
 }
 
 int RenderBase::priority()
@@ -22,6 +26,20 @@ int RenderBase::priority()
 	return _priority;
 }
 
+bool RenderBase::hasProperty(OverlayProperty property) const
+{
+	return property == PropertyPriority;
+}
+
+bool RenderBase::setProperty(OverlayProperty property, int value)
+{
+	if (property != PropertyPriority)
+		return false;
+
+	setPriority(value);
+	return true;
+}
+
 void RenderBase::changeResource()
 {
 	_resourceChanged = true;
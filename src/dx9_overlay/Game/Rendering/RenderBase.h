@@ -11,23 +11,29 @@ public:
 	RenderBase(Renderer *render);
 	virtual ~RenderBase(void);
 
+	// Render thread only, the Renderer re-sorts its draw list before the next frame
 	void setPriority(int p);
 	int priority();
 
+	// Sets one OverlayProperty, false if the object doesn't have it
+	virtual bool setProperty(OverlayProperty property, int value);
+	virtual bool hasProperty(OverlayProperty property) const;
+
 protected:
-	virtual void draw(IDirect3DDevice9 *pDevice)  = 0;
-	virtual void reset(IDirect3DDevice9 *pDevice) = 0;
+	virtual void draw(OverlayDevice *pDevice)  = 0;
+	virtual void reset(OverlayDevice *pDevice) = 0;
 
 	virtual void show() = 0;
 	virtual void hide() = 0;
 
-	virtual void releaseResourcesForDeletion(IDirect3DDevice9 *pDevice) = 0;
+	virtual void releaseResourcesForDeletion(OverlayDevice *pDevice) = 0;
 
 	virtual bool canBeDeleted() = 0;
 
-	virtual bool loadResource(IDirect3DDevice9 *pDevice) = 0;
+	virtual bool loadResource(OverlayDevice *pDevice) = 0;
 
-	virtual void firstDrawAfterReset(IDirect3DDevice9 *pDevice) = 0;
+	// Restores what reset() released, false if that failed
+	virtual bool firstDrawAfterReset(OverlayDevice *pDevice) = 0;
 
 	void changeResource();
 
@@ -40,9 +46,18 @@ protected:
 	Renderer *renderer();
 
 private:
-	bool _hasToBeInitialised, _isMarkedForDeletion, _resourceChanged, _firstDrawAfterReset;
+	// Only used by the render thread
+	bool _hasToBeInitialised, _resourceChanged, _firstDrawAfterReset, _loadFailed;
+
+	// Set by the handlers through remove() and destroyAll(), read by the render thread
+	std::atomic<bool> _isMarkedForDeletion;
+
+	// Set by Renderer::add, reported with EventLoadFailed
+	int _id = -1;
 
 	int _priority = 0;
+	// Set when the object joins the draw list, see Renderer::comparePriority
+	unsigned long long _joinedDrawList = 0;
 
 	Renderer *_renderer;
 };
@@ -30,7 +30,7 @@ RenderStates::~RenderStates()
 	}
 }
 
-void RenderStates::BeginDraw(IDirect3DDevice9 * pDevice)
+void RenderStates::begin()
 {
 	if (m_pStateBlockSaved && m_pStateBlockDraw)
 	{
@@ -39,7 +39,7 @@ void RenderStates::BeginDraw(IDirect3DDevice9 * pDevice)
 	}
 }
 
-void RenderStates::EndDraw(IDirect3DDevice9 * pDevice)
+void RenderStates::end()
 {
 	if (m_pStateBlockSaved && m_pStateBlockDraw)
 		m_pStateBlockSaved->Apply();
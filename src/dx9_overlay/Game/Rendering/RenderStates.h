@@ -1,14 +1,16 @@
 #pragma once
 #include <d3dx9.h>
 
-class RenderStates
+#include "OverlayDevice.h"
+
+class RenderStates : public OverlayStates
 {
 public:
 	RenderStates(IDirect3DDevice9 *pDevice);
 	~RenderStates();
 
-	void BeginDraw(IDirect3DDevice9 *pDevice);
-	void EndDraw(IDirect3DDevice9 *pDevice);
+	virtual void begin() override;
+	virtual void end() override;
 private:
 	LPDIRECT3DSTATEBLOCK9 m_pStateBlockSaved;
 	LPDIRECT3DSTATEBLOCK9 m_pStateBlockDraw;
@@ -1,5 +1,5 @@
-#include <Utils/algorithm.h>
 #include <algorithm>
+#include <iterator>
 
 #include "Renderer.h"
 #include "RenderBase.h"
@@ -8,59 +8,263 @@
 #include <boost/date_time.hpp>
 
 Renderer::RenderObjects	Renderer::_renderObjects;
+std::vector<Renderer::SharedRenderObject> Renderer::_drawList;
+std::vector<int> Renderer::_releasedObjects;
+bool Renderer::_drawOrderChanged = false;
+unsigned long long Renderer::_drawListJoins = 0;
 std::recursive_mutex Renderer::_mtx;
+boost::shared_mutex Renderer::_objectsMtx;
+Renderer::RenderCommands Renderer::_commands;
+boost::thread_specific_ptr<Renderer::UpdateGroups> Renderer::_groups;
+std::atomic<int> Renderer::_coalescedUpdates(0);
+std::vector<Renderer::RenderCommand> Renderer::_applied;
+std::vector<std::pair<std::pair<RenderBase *, int>, size_t> > Renderer::_appliedKeys;
+std::vector<char> Renderer::_replaced;
 
 int Renderer::add(SharedRenderObject Object)
 {
-	std::lock_guard<std::recursive_mutex> l(_mtx);
+	boost::unique_lock<boost::shared_mutex> l(_objectsMtx);
 
-	int id = 0;
+	int id = _renderObjects.insert(Object);
+	Object->_id = id;
+	l.unlock();
 
-	if(!_renderObjects.empty())
-		for(;;id++)
-			if(_renderObjects.find(id) == _renderObjects.end())
-				break;
-	
-	_renderObjects[id] = Object;
+	if (id < 0)
+		return id;
 
+	// The draw list belongs to the render thread, the object joins it before the next frame
+	queueUpdate(Object, KeyJoinDrawList, nullptr);
 	return id;
 }
 
-bool Renderer::remove(int id)
+void Renderer::joinDrawList(const SharedRenderObject& object)
 {
-	std::lock_guard<std::recursive_mutex> l(_mtx);
+	object->_joinedDrawList = _drawListJoins++;
+
+	if (_drawOrderChanged)
+		return _drawList.push_back(object);
 
+	_drawList.insert(std::upper_bound(_drawList.begin(), _drawList.end(), object, comparePriority), object);
+}
+
+// Only marks the object, draw() releases its resources and erases it
+bool Renderer::remove(int id)
+{
 	auto ptr = get(id);
 	if (!ptr)
 		return false;
 
-	return ptr->_isMarkedForDeletion = true;
+	// Inside an update group the object disappears in the same frame as the group's other changes
+	if (_groups.get() && _groups->depth > 0)
+	{
+		queueUpdate(ptr, KeyRemove, [](RenderBase *object, const Update&) { object->_isMarkedForDeletion = true; });
+		return true;
+	}
+
+	ptr->_isMarkedForDeletion = true;
+	return true;
 }
 
 std::shared_ptr<RenderBase> Renderer::get(int id)
 {
-	if (_renderObjects.empty())
-		return nullptr;
+	boost::shared_lock<boost::shared_mutex> l(_objectsMtx);
 
-	if (_renderObjects.find(id) == _renderObjects.end())
+	auto object = _renderObjects.find(id);
+	if (!object || (*object)->_isMarkedForDeletion)
 		return nullptr;
 
-	if (_renderObjects[id]->_isMarkedForDeletion)
-		return nullptr;
+	return *object;
+}
+
+void Renderer::queueUpdate(SharedRenderObject object, int property, ApplyUpdate apply, int value1, int value2, int value3, int value4)
+{
+	RenderCommands::Chain single;
+	RenderCommand& command = beginCommand(single);
+
+	// The command keeps the object alive, so the key can't be reused by another object until it ran
+	command.object = std::move(object);
+	command.property = property;
+	command.apply = apply;
+	command.update.values[0] = value1;
+	command.update.values[1] = value2;
+	command.update.values[2] = value3;
+	command.update.values[3] = value4;
+	command.update.text.clear();
+
+	endCommand(single);
+}
+
+void Renderer::queueUpdate(SharedRenderObject object, int property, ApplyUpdate apply, boost::string_ref text, int value1, int value2, int value3)
+{
+	RenderCommands::Chain single;
+	RenderCommand& command = beginCommand(single);
+
+	command.object = std::move(object);
+	command.property = property;
+	command.apply = apply;
+	command.update.values[0] = value1;
+	command.update.values[1] = value2;
+	command.update.values[2] = value3;
+	command.update.values[3] = 0;
+	command.update.text.assign(text.data(), text.size());
+
+	endCommand(single);
+}
+
+// The command is taken from the queue and still holds what the render thread left in it
+Renderer::RenderCommand& Renderer::beginCommand(RenderCommands::Chain& single)
+{
+	UpdateGroups *groups = _groups.get();
+	return _commands.append(groups && groups->depth > 0 ? groups->commands : single);
+}
+
+void Renderer::endCommand(RenderCommands::Chain& single)
+{
+	_commands.push(single);
+}
+
+int Renderer::coalescedUpdates() const
+{
+	return _coalescedUpdates;
+}
+
+Renderer::UpdateGroup::UpdateGroup(Renderer& renderer) : _renderer(renderer)
+{
+	if (!_groups.get())
+	{
+		_groups.reset(new UpdateGroups);
+		_groups->depth = 0;
+	}
+
+	// A nested group becomes part of the outer one
+	_groups->depth++;
+}
+
+Renderer::UpdateGroup::~UpdateGroup()
+{
+	if (--_groups->depth == 0)
+		_renderer._commands.push(_groups->commands);
+}
+
+// Runs on the render thread before the frame is drawn. Commands are applied in the order
+// they were queued, but only the last one of each object and property.
+void Renderer::applyCommands()
+{
+	size_t count = 0;
+	while (true)
+	{
+		if (count == _applied.size())
+			_applied.resize(count + 1);
+
+		if (!_commands.pop(_applied[count]))
+			break;
+
+		count++;
+	}
+
+	if (count == 0)
+		return;
+
+	// Sorted by object and property, the last command of each key is the one which is applied
+	_appliedKeys.clear();
+	for (size_t i = 0; i < count; i++)
+	{
+		if (_applied[i].object)
+			_appliedKeys.push_back(std::make_pair(std::make_pair(_applied[i].object.get(), _applied[i].property), i));
+	}
+
+	std::sort(_appliedKeys.begin(), _appliedKeys.end());
+
+	_replaced.assign(count, 0);
+	for (size_t i = 1; i < _appliedKeys.size(); i++)
+	{
+		if (_appliedKeys[i].first == _appliedKeys[i - 1].first)
+			_replaced[_appliedKeys[i - 1].second] = 1;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		auto& command = _applied[i];
+
+		if (_replaced[i])
+			_coalescedUpdates++;
+		else if (command.property == KeyJoinDrawList)
+			joinDrawList(command.object);
+		else
+			command.apply(command.object.get(), command.update);
+
+		// Only the text stays, for the producer which reuses the command
+		command.object.reset();
+	}
+}
+
+int Renderer::setProperties(const std::vector<PropertyUpdate>& updates)
+{
+	UpdateGroup group(*this);
+
+	int failed = 0;
+	for (auto it = updates.begin(); it != updates.end(); it++)
+	{
+		auto object = get(it->id);
+		if (!object || !object->hasProperty(it->property))
+		{
+			failed++;
+			continue;
+		}
+
+		// Kept apart from the keys of the setter messages
+		queueUpdate(object, 0x10000 + int(it->property), [](RenderBase *object, const Update& update) {
+			object->setProperty(OverlayProperty(update.values[0]), update.values[1]);
+		}, int(it->property), it->value);
+	}
 
-	return _renderObjects[id];
+	return failed;
 }
 
-void Renderer::draw(IDirect3DDevice9 *pDevice)
+bool Renderer::comparePriority(const SharedRenderObject& i, const SharedRenderObject& j)
+{
+	if (i->priority() != j->priority())
+		return i->priority() < j->priority();
+
+	return i->_joinedDrawList < j->_joinedDrawList;
+}
+
+void Renderer::invalidateDrawOrder()
+{
+	_drawOrderChanged = true;
+}
+
+void Renderer::setEventCallback(EventCallback callback)
+{
+	_eventCallback = callback;
+}
+
+void Renderer::publish(OverlayEvent event, int value1, int value2)
+{
+	if (_eventCallback)
+		_eventCallback(event, value1, value2);
+}
+
+// A failed load is retried every frame, it is only reported the first time
+bool Renderer::checkLoaded(const SharedRenderObject& object, bool bLoaded)
+{
+	if (!bLoaded && !object->_loadFailed)
+		publish(EventLoadFailed, object->_id);
+
+	object->_loadFailed = !bLoaded;
+	return bLoaded;
+}
+
+void Renderer::draw(OverlayDevice *pDevice)
 {
 	std::lock_guard<std::recursive_mutex> l(_mtx);
 
 	// Read frame rate
 	{
-		static DWORD dwFrames = 0;
+		static unsigned int dwFrames = 0;
 		static boost::posix_time::ptime TimeNow;
 		static boost::posix_time::ptime TimeLast = boost::posix_time::microsec_clock::local_time();
-		static DWORD dwElapsedTime = 0;
+		static unsigned int dwElapsedTime = 0;
 	
 		dwFrames++;
 		TimeNow = boost::posix_time::microsec_clock::local_time();
@@ -70,6 +274,8 @@ void Renderer::draw(IDirect3DDevice9 *pDevice)
 		{
 			float fFPS = (((float) dwFrames) * 1000.0f) / ((float) dwElapsedTime);
 			_frameRate = (int) fFPS;
+
+			publish(EventFrameStats, _frameRate, (int) ((dwElapsedTime * 1000) / dwFrames));
 			dwFrames = 0;
 			TimeLast = TimeNow;
 		}
@@ -77,60 +283,79 @@ void Renderer::draw(IDirect3DDevice9 *pDevice)
 
 	// Get frame's screen bounds
 	{
-		D3DVIEWPORT9 viewPort;
-		pDevice->GetViewport(&viewPort);
+		int width = 0, height = 0;
+		pDevice->viewport(width, height);
+
+		if (width != _width || height != _height)
+			publish(EventResolutionChanged, width, height);
 
-		_width = viewPort.Width;
-		_height = viewPort.Height;
+		_width = width;
+		_height = height;
 	}
 
-	if(_renderObjects.empty())
-		return;
+	applyCommands();
 
-	// Delete all objects from the map which are marked for deletion
-	erase_if(_renderObjects, [&](int id, SharedRenderObject obj) -> bool 
+	// Objects marked for deletion leave the draw list once their resources are released
+	auto last = std::remove_if(_drawList.begin(), _drawList.end(), [&](const SharedRenderObject& obj) -> bool
 	{
-		if(obj->_isMarkedForDeletion)
-		{
-			obj->releaseResourcesForDeletion(pDevice);
-			return obj->canBeDeleted();
-		}
+		if(!obj->_isMarkedForDeletion)
+			return false;
 
-		return false;
+		obj->releaseResourcesForDeletion(pDevice);
+		if(!obj->canBeDeleted())
+			return false;
+
+		_releasedObjects.push_back(obj->_id);
+		return true;
 	});
 
+	_drawList.erase(last, _drawList.end());
 
-	// Push all render objects in a vector which will be sorted later
-	std::vector<SharedRenderObject> sortedObjects;
-	for (auto it = _renderObjects.begin(); it != _renderObjects.end(); it++)
-		sortedObjects.push_back(it->second);
+	// The frame never waits for a handler which holds the map, the objects are erased at a later one.
+	// get() skips them meanwhile and their handles aren't reused.
+	if(!_releasedObjects.empty())
+	{
+		boost::unique_lock<boost::shared_mutex> lock(_objectsMtx, boost::try_to_lock);
+		if(lock.owns_lock())
+		{
+			for(auto it = _releasedObjects.begin(); it != _releasedObjects.end(); it++)
+				_renderObjects.erase(*it);
 
-	// Sort render objects by priority
-	std::sort(sortedObjects.begin(), sortedObjects.end(), [](SharedRenderObject& i, SharedRenderObject& j){
-		return i->priority() < j->priority();
-	});
+			_releasedObjects.clear();
+		}
+	}
+
+	// Only needed after a priority changed, objects with the same priority are drawn in the order they were added
+	if(_drawOrderChanged)
+	{
+		std::sort(_drawList.begin(), _drawList.end(), comparePriority);
+		_drawOrderChanged = false;
+	}
 
 	// Process sorted render objects
-	for (auto& i : sortedObjects)
+	for (auto& i : _drawList)
 	{
 		if(i->_hasToBeInitialised)
 		{
-			if(!i->loadResource(pDevice))
+			if(!checkLoaded(i, i->loadResource(pDevice)))
 				continue;
 
 			i->_hasToBeInitialised = false;
 		}
 
+		// Like a failed load, the object isn't drawn until its resources are back
 		if(i->_firstDrawAfterReset)
 		{
-			i->firstDrawAfterReset(pDevice);
+			if(!checkLoaded(i, i->firstDrawAfterReset(pDevice)))
+				continue;
+
 			i->_firstDrawAfterReset = false;
 		}
 
 		if(i->_resourceChanged)
 		{
 			i->releaseResourcesForDeletion(pDevice);
-			if(!i->loadResource(pDevice))
+			if(!checkLoaded(i, i->loadResource(pDevice)))
 				continue;
 
 			i->_resourceChanged = false;
@@ -140,61 +365,52 @@ void Renderer::draw(IDirect3DDevice9 *pDevice)
 	}
 }
 
-void Renderer::reset(IDirect3DDevice9 *pDevice)
+void Renderer::reset(OverlayDevice *pDevice)
 {
 	std::lock_guard<std::recursive_mutex> l(_mtx);
 
-	if(_renderObjects.empty())
-		return;
-	
-	for(auto it = _renderObjects.begin(); it != _renderObjects.end(); it ++)
+	publish(EventDeviceReset);
+
+	for(auto it = _drawList.begin(); it != _drawList.end(); it ++)
 	{
-		it->second->reset(pDevice);
-		it->second->_firstDrawAfterReset = true;
+		(*it)->reset(pDevice);
+		(*it)->_firstDrawAfterReset = true;
 	}
 }
 
 void Renderer::showAll()
 {
-	std::lock_guard<std::recursive_mutex> l(_mtx);
-
-	if(_renderObjects.empty())
-		return;
-
-	for(auto it = _renderObjects.begin(); it != _renderObjects.end();it ++)
-	{
-		if(it->second->_isMarkedForDeletion)
-			continue;
+	queueUpdate(nullptr, 0, [](RenderBase *, const Update&) {
+		for(auto it = _drawList.begin(); it != _drawList.end();it ++)
+		{
+			if((*it)->_isMarkedForDeletion)
+				continue;
 
-		it->second->show();
-	}
+			(*it)->show();
+		}
+	});
 }
 
 void Renderer::hideAll()
 {
-	std::lock_guard<std::recursive_mutex> l(_mtx);
-
-	if(_renderObjects.empty())
-		return;
-
-	for(auto it = _renderObjects.begin(); it != _renderObjects.end();it ++)
-	{
-		if(it->second->_isMarkedForDeletion)
-			continue;
+	queueUpdate(nullptr, 0, [](RenderBase *, const Update&) {
+		for(auto it = _drawList.begin(); it != _drawList.end();it ++)
+		{
+			if((*it)->_isMarkedForDeletion)
+				continue;
 
-		it->second->hide();
-	}
+			(*it)->hide();
+		}
+	});
 }
 
+// Like remove(), draw() releases the objects
 void Renderer::destroyAll()
 {
-	std::lock_guard<std::recursive_mutex> l(_mtx);
-
-	if(_renderObjects.empty())
-		return;
+	boost::shared_lock<boost::shared_mutex> lock(_objectsMtx);
 
 	for(auto it = _renderObjects.begin(); it != _renderObjects.end(); it ++)
-		it->second->_isMarkedForDeletion = true;
+		(*it)->_isMarkedForDeletion = true;
 }
 
 int Renderer::frameRate() const
@@ -211,8 +427,3 @@ int Renderer::screenHeight() const
 {
 	return _height;
 }
-
-std::recursive_mutex& Renderer::renderMutex()
-{
-	return _mtx;
-}
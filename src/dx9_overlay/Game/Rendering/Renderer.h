@@ -1,19 +1,71 @@
 #pragma once
-#include <d3dx9.h>
+#include <Shared/Protocol.h>
+#include <Utils/MpscQueue.h>
+#include <Utils/SlotMap.h>
 
 #include <memory>
 #include <map>
+#include <string>
+#include <vector>
 #include <functional>
 #include <mutex>
+#include <atomic>
+
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include "OverlayDevice.h"
 
 class RenderBase;
 
 class Renderer
 {
+	friend class RenderBase;
+
 	typedef std::shared_ptr<RenderBase> SharedRenderObject;
-	typedef std::map<int, SharedRenderObject> RenderObjects;
+	typedef SlotMap<SharedRenderObject> RenderObjects;
+
+public:
+	// Payload of an update. Its text keeps the buffer when the queue reuses the command,
+	// so a queued update doesn't allocate once the queue has warmed up.
+	struct Update
+	{
+		int values[4];
+		std::string text;
+	};
+
+	// Applies an update on the render thread. Commands of the whole renderer get no object.
+	typedef void (*ApplyUpdate)(RenderBase *object, const Update& update);
+
+private:
+	struct RenderCommand
+	{
+		// Null for commands which are never replaced by a later one
+		SharedRenderObject object;
+		int property;
+		ApplyUpdate apply;
+		Update update;
+	};
+
+	typedef MpscQueue<RenderCommand> RenderCommands;
+
+	// Keys of the renderer's own commands, apart from the keys of the setters
+	enum { KeyRemove = -1, KeyJoinDrawList = -2 };
+
+	// The update groups of a thread, kept for its later groups
+	struct UpdateGroups
+	{
+		RenderCommands::Chain commands;
+		int depth;
+	};
 
 public:
+	typedef std::function<void(OverlayEvent event, int value1, int value2)> EventCallback;
+
+	// Receives the events of the render thread, set before the first frame is drawn
+	void setEventCallback(EventCallback callback);
+
 	int add(SharedRenderObject Object);
 
 	bool remove(int id);
@@ -21,16 +73,7 @@ public:
 	template<typename T> 
 	std::shared_ptr<T> getAs(int id)
 	{
-		if(_renderObjects.empty())
-			return nullptr;
-
-		if(_renderObjects.find(id) == _renderObjects.end())
-			return nullptr;
-
-		if(_renderObjects[id]->_isMarkedForDeletion)
-			return nullptr;
-
-		return std::dynamic_pointer_cast<T, RenderBase>(_renderObjects[id]);
+		return std::dynamic_pointer_cast<T, RenderBase>(get(id));
 	}
 
 	std::shared_ptr<RenderBase> get(int id);
@@ -46,8 +89,44 @@ public:
 			return error();
 	}
 
-	void draw(IDirect3DDevice9 *pDevice);
-	void reset(IDirect3DDevice9 *pDevice);
+	// Queues an update for the render thread, 'apply' gets the values before the next frame. A later
+	// update of the same property of the object replaces it, so only the last value set between two
+	// frames is applied.
+	void queueUpdate(SharedRenderObject object, int property, ApplyUpdate apply, int value1 = 0, int value2 = 0, int value3 = 0, int value4 = 0);
+
+	// Like queueUpdate(), 'apply' gets a copy of the text as Update::text
+	void queueUpdate(SharedRenderObject object, int property, ApplyUpdate apply, boost::string_ref text, int value1 = 0, int value2 = 0, int value3 = 0);
+
+	// Collects the updates and removals queued by this thread while it exists and queues them
+	// at once, a frame shows either none or all of them
+	class UpdateGroup
+	{
+	public:
+		UpdateGroup(Renderer& renderer);
+		~UpdateGroup();
+
+	private:
+		UpdateGroup(const UpdateGroup&);
+		UpdateGroup& operator=(const UpdateGroup&);
+
+		Renderer& _renderer;
+	};
+
+	// Number of updates which were replaced before they were applied
+	int coalescedUpdates() const;
+
+	struct PropertyUpdate
+	{
+		int id;
+		OverlayProperty property;
+		int value;
+	};
+
+	// Queues all updates at once, returns how many of them name a missing object or property
+	int setProperties(const std::vector<PropertyUpdate>& updates);
+
+	void draw(OverlayDevice *pDevice);
+	void reset(OverlayDevice *pDevice);
 
 	void showAll();
 	void hideAll();
@@ -58,12 +137,50 @@ public:
 	int screenWidth() const;
 	int screenHeight() const;
 
-	std::recursive_mutex& renderMutex();
-
 private:
-	int _frameRate, _width, _height;
+	// Fills in a command which is queued by endCommand(), or with the open update group
+	RenderCommand& beginCommand(RenderCommands::Chain& single);
+	void endCommand(RenderCommands::Chain& single);
+
+	void applyCommands();
+	static void joinDrawList(const SharedRenderObject& object);
+	void invalidateDrawOrder();
+	static bool comparePriority(const SharedRenderObject& i, const SharedRenderObject& j);
+	void publish(OverlayEvent event, int value1 = 0, int value2 = 0);
+	bool checkLoaded(const SharedRenderObject& object, bool bLoaded);
+
+	// Written by the render thread, read by the handlers
+	std::atomic<int> _frameRate, _width, _height;
+
+	EventCallback _eventCallback;
 
 	static RenderObjects _renderObjects;
+
+	// Live objects sorted by priority, only used by the render thread
+	static std::vector<SharedRenderObject> _drawList;
+	static bool _drawOrderChanged;
+	// Counts the objects which joined the draw list, orders objects of the same priority
+	static unsigned long long _drawListJoins;
+
+	// Handles of objects which have left the draw list but are still in the map
+	static std::vector<int> _releasedObjects;
+
+	// Only taken by the render thread, handlers never wait for a frame
 	static std::recursive_mutex _mtx;
+
+	// Guards the map itself, so handlers can look up objects without waiting for a frame.
+	// The render thread only ever tries to take it, a frame never waits for a handler.
+	static boost::shared_mutex _objectsMtx;
+
+	// Drained by draw(), the commands of an update group are pushed at once
+	static RenderCommands _commands;
+	static boost::thread_specific_ptr<UpdateGroups> _groups;
+	static std::atomic<int> _coalescedUpdates;
+
+	// Only used by the render thread. The commands of the previous frames are popped into, their
+	// text buffers go back to the queue. The keys find the commands which were replaced.
+	static std::vector<RenderCommand> _applied;
+	static std::vector<std::pair<std::pair<RenderBase *, int>, size_t> > _appliedKeys;
+	static std::vector<char> _replaced;
 };
 
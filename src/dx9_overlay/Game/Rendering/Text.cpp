@@ -1,10 +1,9 @@
 ﻿#include <Utils/SafeBlock.h>
 
 #include "Text.h"
-#include "dx_utils.h"
 
-Text::Text(Renderer *renderer, const std::string& font,int iFontSize,bool Bold,bool Italic,int x,int y,D3DCOLOR color,const std::string& text, bool bShadow, bool bShow)
-	: RenderBase(renderer), m_D3DFont(NULL)
+Text::Text(Renderer *renderer, boost::string_ref font, int iFontSize, bool Bold, bool Italic, int x, int y, unsigned int color, boost::string_ref text, bool bShadow, bool bShow)
+	: RenderBase(renderer)
 {
 	setPos(x,y);
 	setColor(color);
@@ -12,35 +11,15 @@ Text::Text(Renderer *renderer, const std::string& font,int iFontSize,bool Bold,b
 	setShadow(bShadow);
 	setShown(bShow);
 
-	m_Font = MultiByteToWide(font);
+	m_Font.assign(font.begin(), font.end());
 	m_FontSize = iFontSize;
 	m_bBold = Bold;
 	m_bItalic = Italic;
 }
 
-Text::Text(Renderer *renderer, const std::wstring& font, int iFontSize, bool Bold, bool Italic, int x, int y, D3DCOLOR color, const std::wstring& text, bool bShadow, bool bShow)
-	: RenderBase(renderer), m_D3DFont(NULL)
+bool Text::updateText(boost::string_ref Font, int FontSize, bool Bold, bool Italic)
 {
-	setPos(x, y);
-	setColor(color);
-	setText(text);
-	setShadow(bShadow);
-	setShown(bShow);
-
-	m_Font = font;
-	m_FontSize = iFontSize;
-	m_bBold = Bold;
-	m_bItalic = Italic;
-}
-
-bool Text::updateText(const std::string& Font, int FontSize, bool Bold, bool Italic)
-{
-	return updateText(MultiByteToWide(Font), FontSize, Bold, Italic);
-}
-
-bool Text::updateText(const std::wstring& Font,int FontSize,bool Bold,bool Italic)
-{
-	m_Font = Font;
+	m_Font.assign(Font.begin(), Font.end());
 	m_FontSize = FontSize;
 	m_bBold = Bold;
 	m_bItalic = Italic;
@@ -49,17 +28,12 @@ bool Text::updateText(const std::wstring& Font,int FontSize,bool Bold,bool Itali
 	return true;
 }
 
-void Text::setText(const std::string& str)
-{
-	setText(MultiByteToWide(str));
-}
-
-void Text::setText(const std::wstring& str)
+void Text::setText(boost::string_ref str)
 {
-	m_text = str;
+	m_text.assign(str.begin(), str.end());
 }
 
-void Text::setColor(D3DCOLOR color)
+void Text::setColor(unsigned int color)
 {
 	m_Color = color;
 }
@@ -79,9 +53,56 @@ void Text::setShadow(bool bShadow)
 	m_bShadow = bShadow;
 }
 
-void Text::draw(IDirect3DDevice9 *pDevice)
+bool Text::hasProperty(OverlayProperty property) const
+{
+	switch (property)
+	{
+	case PropertyShown:
+	case PropertyX:
+	case PropertyY:
+	case PropertyColor:
+	case PropertyShadow:
+		return true;
+
+	default:
+		return RenderBase::hasProperty(property);
+	}
+}
+
+bool Text::setProperty(OverlayProperty property, int value)
 {
-	if(!m_bShown)
+	switch (property)
+	{
+	case PropertyShown:
+		setShown(value != 0);
+		break;
+
+	case PropertyX:
+		m_X = value;
+		break;
+
+	case PropertyY:
+		m_Y = value;
+		break;
+
+	case PropertyColor:
+		setColor((unsigned int) value);
+		break;
+
+	case PropertyShadow:
+		setShadow(value != 0);
+		break;
+
+	default:
+		return RenderBase::setProperty(property, value);
+	}
+
+	return true;
+}
+
+void Text::draw(OverlayDevice *)
+{
+	if(!m_bShown || m_font == nullptr)
 		return;
 
 	int x = calculatedXPos(m_X);
@@ -91,16 +112,16 @@ void Text::draw(IDirect3DDevice9 *pDevice)
 	{
 		const int shadowOffset = 1;
 
-		drawText(x - shadowOffset, y, D3DCOLOR_ARGB(255, 0, 0, 0), m_text);
-		drawText(x + shadowOffset, y, D3DCOLOR_ARGB(255, 0, 0, 0), m_text);
-		drawText(x, y - shadowOffset, D3DCOLOR_ARGB(255, 0, 0, 0), m_text);
-		drawText(x, y + shadowOffset, D3DCOLOR_ARGB(255, 0, 0, 0), m_text);
+		drawText(x - shadowOffset, y, 0xFF000000, m_text);
+		drawText(x + shadowOffset, y, 0xFF000000, m_text);
+		drawText(x, y - shadowOffset, 0xFF000000, m_text);
+		drawText(x, y + shadowOffset, 0xFF000000, m_text);
 	}
 
-	drawText(x, y, m_Color, m_text, D3DFONT_COLORTABLE);
+	drawText(x, y, m_Color, m_text, OVERLAY_TEXT_COLORTABLE);
 }
 
-void Text::reset(IDirect3DDevice9 *pDevice)
+void Text::reset(OverlayDevice *)
 {
 	resetFont();
 }
@@ -115,61 +136,42 @@ void Text::hide()
 	setShown(false);
 }
 
-void Text::releaseResourcesForDeletion(IDirect3DDevice9 *pDevice)
+void Text::releaseResourcesForDeletion(OverlayDevice *)
 {
 	resetFont();
 }
 
 bool Text::canBeDeleted()
 {
-	return m_D3DFont == nullptr;
+	return m_font == nullptr;
 }
 
-bool Text::loadResource(IDirect3DDevice9 *pDevice)
+bool Text::loadResource(OverlayDevice *pDevice)
 {
 	initFont(pDevice);
-	return true;
-}
-
-void Text::firstDrawAfterReset(IDirect3DDevice9 *pDevice)
-{
-	loadResource(pDevice);
+	return m_font != nullptr;
 }
 
-std::wstring Text::MultiByteToWide(const std::string & multiByte)
+bool Text::firstDrawAfterReset(OverlayDevice *pDevice)
 {
-	int length = multiByte.length();
-
-	if (length > 0)
-	{
-		auto nativeWideString = std::unique_ptr<wchar_t>(new wchar_t[length + 1]);
-		nativeWideString.get()[length] = '\0';
-		MultiByteToWideChar(CP_ACP, MB_PRECOMPOSED, multiByte.c_str(), length, nativeWideString.get(), length);
-
-		std::wstring newString = std::wstring(nativeWideString.get());
-		return newString;
-	}
-
-	return std::wstring();
+	return loadResource(pDevice);
 }
 
-void Text::initFont(IDirect3DDevice9 *pDevice)
+void Text::initFont(OverlayDevice *pDevice)
 {
 	int size = calculatedYPos(m_FontSize);
 
-	m_D3DFont = std::make_shared<CD3DFont>(m_Font.c_str(), size, (m_bBold) ? D3DFONT_BOLD : 0 | (m_bItalic) ? D3DFONT_ITALIC : 0 | D3DFONT_FILTERED);
-	m_D3DFont->InitDeviceObjects(pDevice);
-	m_D3DFont->RestoreDeviceObjects();
+	m_font = pDevice->createFont(m_Font, size, (m_bBold) ? OVERLAY_FONT_BOLD : 0 | (m_bItalic) ? OVERLAY_FONT_ITALIC : 0 | OVERLAY_TEXT_FILTERED);
 }
 
 void Text::resetFont()
 {
-	m_D3DFont.reset();
+	m_font.reset();
 }
 
-bool Text::drawText(int x, int y, DWORD dwColor, const std::wstring& strText, DWORD dwFlags /*= 0L*/)
+bool Text::drawText(int x, int y, unsigned int dwColor, const std::string& strText, unsigned int dwFlags /*= 0L*/)
 {
 	return safeExecuteWithValidation([&](){
-		m_D3DFont->DrawTextA((float)x, (float)y, dwColor, m_text.c_str(), dwFlags);
+		m_font->draw((float)x, (float)y, dwColor, strText, dwFlags);
 	});
 }
@@ -1,51 +1,51 @@
 #pragma once
 #include <string>
 #include <memory>
-#include <d3dx9.h>
 
-#include "D3DFont.h"
+#include <boost/utility/string_ref.hpp>
+
 #include "RenderBase.h"
 
 class Text : public RenderBase
 {
 public:
-	Text(Renderer *renderer, const std::string& font, int iFontSize, bool Bold, bool Italic, int x, int y, D3DCOLOR color, const std::string& text, bool bShadow, bool bShow);
-	Text(Renderer *renderer, const std::wstring& font, int iFontSize, bool Bold, bool Italic, int x, int y, D3DCOLOR color, const std::wstring& text, bool bShadow, bool bShow);
-
-	bool updateText(const std::string& Font, int FontSize, bool Bold, bool Italic);
-	bool updateText(const std::wstring& Font,int FontSize,bool Bold,bool Italic);
-	void setText(const std::string& str);
-	void setText(const std::wstring& str);
-	void setColor(D3DCOLOR color);
+	// Font and text are UTF-8
+	Text(Renderer *renderer, boost::string_ref font, int iFontSize, bool Bold, bool Italic, int x, int y, unsigned int color, boost::string_ref text, bool bShadow, bool bShow);
+
+	bool updateText(boost::string_ref Font, int FontSize, bool Bold, bool Italic);
+	void setText(boost::string_ref str);
+	void setColor(unsigned int color);
 	void setPos(int x,int y);
 	void setShown(bool bShow);
 	void setShadow(bool bShadow);
 
+	virtual bool setProperty(OverlayProperty property, int value) override final;
+	virtual bool hasProperty(OverlayProperty property) const override final;
+
 protected:
-	virtual void draw(IDirect3DDevice9 *pDevice) sealed;
-	virtual void reset(IDirect3DDevice9 *pDevice) sealed;
+	virtual void draw(OverlayDevice *pDevice) final;
+	virtual void reset(OverlayDevice *pDevice) final;
 
-	virtual void show() override sealed;
-	virtual void hide() override sealed;
+	virtual void show() override final;
+	virtual void hide() override final;
 
-	virtual void releaseResourcesForDeletion(IDirect3DDevice9 *pDevice) override sealed;
-	virtual bool canBeDeleted() override sealed;
+	virtual void releaseResourcesForDeletion(OverlayDevice *pDevice) override final;
+	virtual bool canBeDeleted() override final;
 
-	virtual bool loadResource(IDirect3DDevice9 *pDevice) override sealed;
-	virtual void firstDrawAfterReset(IDirect3DDevice9 *pDevice) override sealed;
+	virtual bool loadResource(OverlayDevice *pDevice) override final;
+	virtual bool firstDrawAfterReset(OverlayDevice *pDevice) override final;
 
 private:
-	std::wstring m_text;
-	std::wstring m_Font;
+	// Kept as UTF-8, setText() reuses the capacity so repeated updates don't allocate
+	std::string m_text;
+	std::string m_Font;
 	int	m_X, m_Y, m_FontSize;
-	D3DCOLOR m_Color;
-	std::shared_ptr<CD3DFont> m_D3DFont;
+	unsigned int m_Color;
+	std::unique_ptr<OverlayFont> m_font;
 	bool m_bShown, m_bShadow, m_bItalic, m_bBold;
 
-	std::wstring MultiByteToWide(const std::string &multiByte);
-
-	void initFont(IDirect3DDevice9 *pDevice);
+	void initFont(OverlayDevice *pDevice);
 	void resetFont();
-	bool drawText(int x, int y, DWORD dwColor, const std::wstring& strText, DWORD dwFlags = 0L);
+	bool drawText(int x, int y, unsigned int dwColor, const std::string& strText, unsigned int dwFlags = 0L);
 };
 
@@ -1,80 +1,26 @@
 #include "dx_utils.h"
-#include "D3DFont.h"
 
-void Drawing::DrawBox(float x, float y, float w, float h, DWORD color, LPDIRECT3DDEVICE9 pDevice)
+void Drawing::DrawBox(float x, float y, float w, float h, unsigned int color, OverlayDevice *pDevice)
 {
-	stVertex q[4];
+	OverlayVertex q[4];
 
-	q[0].dwColor = q[1].dwColor = q[2].dwColor = q[3].dwColor = color;
+	q[0].color = q[1].color = q[2].color = q[3].color = color;
 
-	q[0].fZ = q[1].fZ = q[2].fZ = q[3].fZ = 0;
-	q[0].fRHW = q[1].fRHW = q[2].fRHW = q[3].fRHW = 0;
+	q[0].z = q[1].z = q[2].z = q[3].z = 0;
+	q[0].rhw = q[1].rhw = q[2].rhw = q[3].rhw = 0;
 
-	q[0].fX = q[2].fX = x;
-	q[0].fY = q[1].fY = y;
-	q[1].fX = q[3].fX = x + w;
-	q[2].fY = q[3].fY = y + h;
+	q[0].x = q[2].x = x;
+	q[0].y = q[1].y = y;
+	q[1].x = q[3].x = x + w;
+	q[2].y = q[3].y = y + h;
 
-	Drawing::DrawPrimtive(pDevice, D3DPT_TRIANGLESTRIP, 2, q, sizeof(stVertex));
+	pDevice->drawTriangleStrip(q, 2);
 }
 
-void Drawing::DrawRectangular(float X, float Y, float Width, float Height, float Thickness, D3DCOLOR Color, LPDIRECT3DDEVICE9 pDev)
+void Drawing::DrawRectangular(float X, float Y, float Width, float Height, float Thickness, unsigned int Color, OverlayDevice *pDev)
 {
 	Drawing::DrawBox(X, Y + Height - Thickness, Width, Thickness, Color, pDev);
 	Drawing::DrawBox(X, Y, Thickness, Height, Color, pDev);
 	Drawing::DrawBox(X, Y, Width, Thickness, Color, pDev);
 	Drawing::DrawBox(X + Width - Thickness, Y, Thickness, Height, Color, pDev);
 }
-
-void Drawing::DrawPrimtive(LPDIRECT3DDEVICE9 pDevice, D3DPRIMITIVETYPE PrimitiveType, UINT PrimitiveCount, CONST void* pVertexStreamZeroData, UINT VertexStreamZeroStride, DWORD FVF)
-{
-	DWORD dwOldFVF;
-	LPDIRECT3DPIXELSHADER9 ppixelShader;
-	LPDIRECT3DBASETEXTURE9 ppTexture;
-
-	pDevice->GetFVF(&dwOldFVF);
-	pDevice->GetPixelShader(&ppixelShader);
-	pDevice->GetTexture(0, &ppTexture);
-
-	pDevice->SetPixelShader(NULL);
-	pDevice->SetTexture(0, NULL);
-	pDevice->SetFVF(FVF);
-
-	pDevice->DrawPrimitiveUP(PrimitiveType, PrimitiveCount, pVertexStreamZeroData, VertexStreamZeroStride);
-
-	pDevice->SetPixelShader(ppixelShader);
-	pDevice->SetTexture(0, ppTexture);
-	pDevice->SetFVF(dwOldFVF);
-}
-
-void Drawing::DrawSprite(LPD3DXSPRITE SpriteInterface, LPDIRECT3DTEXTURE9 TextureInterface, int PosX, int PosY, int Rotation, int Align, float scaleX, float scaleY)
-{
-	if (SpriteInterface == NULL || TextureInterface == NULL)
-		return;
-
-	D3DXVECTOR3 Vec;
-
-	Vec.x = (FLOAT) PosX;
-	Vec.y = (FLOAT) PosY;
-	Vec.z = (FLOAT)0.0f;
-
-	D3DXMATRIX mat;
-	D3DXVECTOR2 scaling(scaleX, scaleY);
-	D3DSURFACE_DESC desc;
-
-	TextureInterface->GetLevelDesc(0, &desc);
-
-	D3DXVECTOR2 spriteCentre;
-	if (Align == 1)
-		spriteCentre = D3DXVECTOR2((FLOAT) desc.Width / 2, (FLOAT) desc.Height / 2);
-	else
-		spriteCentre = D3DXVECTOR2(0, 0);
-
-	D3DXVECTOR2 trans = D3DXVECTOR2(0, 0);
-	D3DXMatrixTransformation2D(&mat, NULL, 0.0, &scaling, &spriteCentre, (FLOAT) Rotation, &trans);
-
-	SpriteInterface->SetTransform(&mat);
-	SpriteInterface->Begin(D3DXSPRITE_ALPHABLEND);
-	SpriteInterface->Draw(TextureInterface, NULL, NULL, &Vec, 0xFFFFFFFF);
-	SpriteInterface->End();
-}
@@ -1,3 +1,9 @@
 #pragma once
 
-const char *const g_strPipeName = "Overlay_Server";
\ No newline at end of file
+const char *const g_strPipeName = "Overlay_Server";
+
+// Only written by the server, see OverlayEvent
+const char *const g_strEventPipeName = "Overlay_Server_Events";
+
+// Formatted with the game's process id. Signalled by the server once its pipe accepts connections.
+const char *const g_strReadyEventFormat = "Local\\Overlay_Server_Ready_%lu";
\ No newline at end of file
@@ -0,0 +1,251 @@
+#pragma once
+#include "PipeMessages.h"
+#include "Protocol.h"
+
+#include <Utils/Serializer.h>
+
+#include <boost/utility/string_ref.hpp>
+
+#include <string>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+// Single description of every PipeMessages payload. The client encoder and the server
+// decoder are both generated from it, so the argument order can't drift apart.
+//
+//	MESSAGE_SCHEMA(Name, ReplyType, ArgumentTypes...)
+//
+// Strings are UTF-8, sent as boost::string_ref and decoded as views into the request buffer.
+// A void reply means that the server answers with an empty message.
+template<PipeMessages M>
+struct MessageSchema;
+
+typedef std::pair<int, int> ScreenSpecs;
+
+#define MESSAGE_SCHEMA(M, R, ...)						\
+template<> struct MessageSchema<PipeMessages::M>		\
+{														\
+	typedef R Reply;									\
+	typedef std::tuple<__VA_ARGS__> Args;				\
+};
+
+MESSAGE_SCHEMA(Ping, void)
+
+MESSAGE_SCHEMA(TextCreate, int, boost::string_ref, int, bool, bool, int, int, unsigned int, boost::string_ref, bool, bool)
+MESSAGE_SCHEMA(TextDestroy, int, int)
+MESSAGE_SCHEMA(TextSetShadow, int, int, bool)
+MESSAGE_SCHEMA(TextSetShown, int, int, bool)
+MESSAGE_SCHEMA(TextSetColor, int, int, unsigned int)
+MESSAGE_SCHEMA(TextSetPos, int, int, int, int)
+MESSAGE_SCHEMA(TextSetString, int, int, boost::string_ref)
+MESSAGE_SCHEMA(TextUpdate, int, int, boost::string_ref, int, bool, bool)
+
+MESSAGE_SCHEMA(BoxCreate, int, int, int, int, int, unsigned int, bool)
+MESSAGE_SCHEMA(BoxDestroy, int, int)
+MESSAGE_SCHEMA(BoxSetShown, int, int, bool)
+MESSAGE_SCHEMA(BoxSetBorder, int, int, int, bool)
+MESSAGE_SCHEMA(BoxSetBorderColor, int, int, unsigned int)
+MESSAGE_SCHEMA(BoxSetColor, int, int, unsigned int)
+MESSAGE_SCHEMA(BoxSetHeight, int, int, int)
+MESSAGE_SCHEMA(BoxSetPos, int, int, int, int)
+MESSAGE_SCHEMA(BoxSetWidth, int, int, int)
+
+MESSAGE_SCHEMA(LineCreate, int, int, int, int, int, int, unsigned int, bool)
+MESSAGE_SCHEMA(LineDestroy, int, int)
+MESSAGE_SCHEMA(LineSetShown, int, int, bool)
+MESSAGE_SCHEMA(LineSetColor, int, int, unsigned int)
+MESSAGE_SCHEMA(LineSetWidth, int, int, int)
+MESSAGE_SCHEMA(LineSetPos, int, int, int, int, int, int)
+
+MESSAGE_SCHEMA(ImageCreate, int, boost::string_ref, int, int, int, int, bool)
+MESSAGE_SCHEMA(ImageDestroy, int, int)
+MESSAGE_SCHEMA(ImageSetShown, int, int, bool)
+MESSAGE_SCHEMA(ImageSetAlign, int, int, int)
+MESSAGE_SCHEMA(ImageSetPos, int, int, int, int)
+MESSAGE_SCHEMA(ImageSetRotation, int, int, int)
+
+MESSAGE_SCHEMA(DestroyAllVisual, void)
+MESSAGE_SCHEMA(ShowAllVisual, void)
+MESSAGE_SCHEMA(HideAllVisual, void)
+
+MESSAGE_SCHEMA(GetFrameRate, int)
+MESSAGE_SCHEMA(GetScreenSpecs, ScreenSpecs)
+
+MESSAGE_SCHEMA(SetCalculationRatio, void, int, int)
+MESSAGE_SCHEMA(SetOverlayPriority, int, int, int)
+
+// Argument: the client's PROTOCOL_VERSION
+MESSAGE_SCHEMA(Handshake, ServerInfo, int)
+
+// Returns a handle for the string which can replace it in the *Interned messages, 0 if the table is full
+MESSAGE_SCHEMA(StringIntern, int, boost::string_ref)
+MESSAGE_SCHEMA(TextCreateInterned, int, int, int, bool, bool, int, int, unsigned int, boost::string_ref, bool, bool)
+MESSAGE_SCHEMA(TextUpdateInterned, int, int, int, int, bool, bool)
+
+// Argument: the client's process id. Returns the id of a SharedMemoryChannel, 0 on failure
+MESSAGE_SCHEMA(OpenSharedMemory, int, int)
+
+// Returns the number of one-way messages which have failed since the last Sync
+MESSAGE_SCHEMA(Sync, int)
+
+// Arguments: number of commands, the encoded setter messages. Returns how many of them failed.
+// The server applies all of them without drawing a frame in between.
+MESSAGE_SCHEMA(Batch, int, int, boost::string_ref)
+
+// Returns how many setters were replaced by a later one before the server applied them
+MESSAGE_SCHEMA(GetCoalescedUpdates, int)
+
+// Arguments: number of records, the records as three ints each: object id, OverlayProperty, value.
+// Returns how many of them failed. The server applies all of them without drawing a frame in between.
+MESSAGE_SCHEMA(BulkUpdate, int, int, boost::string_ref)
+
+// Drops the reference a StringIntern took, the handle may be invalid afterwards. Returns 0 for an invalid handle.
+MESSAGE_SCHEMA(StringRelease, int, int)
+
+// Retired ids, they have no schema and the server treats them like unknown ids
+template<PipeMessages M> struct IsReserved : std::false_type {};
+
+#define RESERVED_MESSAGE(M) template<> struct IsReserved<PipeMessages::M> : std::true_type {};
+
+RESERVED_MESSAGE(ReservedTextCreateUnicode)
+RESERVED_MESSAGE(ReservedTextSetStringUnicode)
+RESERVED_MESSAGE(ReservedTextUpdateUnicode)
+
+// Setters may be sent one-way, their reply only reports success (1) or failure (0)
+template<PipeMessages M> struct IsSetter : std::false_type {};
+
+#define SETTER_MESSAGE(M) template<> struct IsSetter<PipeMessages::M> : std::true_type {};
+
+SETTER_MESSAGE(TextDestroy)
+SETTER_MESSAGE(TextSetShadow)
+SETTER_MESSAGE(TextSetShown)
+SETTER_MESSAGE(TextSetColor)
+SETTER_MESSAGE(TextSetPos)
+SETTER_MESSAGE(TextSetString)
+
+SETTER_MESSAGE(BoxDestroy)
+SETTER_MESSAGE(BoxSetShown)
+SETTER_MESSAGE(BoxSetBorder)
+SETTER_MESSAGE(BoxSetBorderColor)
+SETTER_MESSAGE(BoxSetColor)
+SETTER_MESSAGE(BoxSetHeight)
+SETTER_MESSAGE(BoxSetPos)
+SETTER_MESSAGE(BoxSetWidth)
+
+SETTER_MESSAGE(LineDestroy)
+SETTER_MESSAGE(LineSetShown)
+SETTER_MESSAGE(LineSetColor)
+SETTER_MESSAGE(LineSetWidth)
+SETTER_MESSAGE(LineSetPos)
+
+SETTER_MESSAGE(ImageDestroy)
+SETTER_MESSAGE(ImageSetShown)
+SETTER_MESSAGE(ImageSetAlign)
+SETTER_MESSAGE(ImageSetPos)
+SETTER_MESSAGE(ImageSetRotation)
+
+SETTER_MESSAGE(SetOverlayPriority)
+SETTER_MESSAGE(StringRelease)
+
+inline Serializer& operator<<(Serializer& serializer, const ServerInfo& info)
+{
+	return serializer << info.protocolVersion << info.maxMessageSize << info.encodings << info.features;
+}
+
+inline Serializer& operator>>(Serializer& serializer, ServerInfo& info)
+{
+	return serializer >> info.protocolVersion >> info.maxMessageSize >> info.encodings >> info.features;
+}
+
+// Largest encoded size of a single field, variable sized fields are marked as not fixed
+template<typename T> struct WireSize { enum { fixed = true, max = sizeof(T) }; };
+template<> struct WireSize<bool> { enum { fixed = true, max = 1 }; };
+template<> struct WireSize<int> { enum { fixed = true, max = 5 }; };
+template<> struct WireSize<boost::string_ref> { enum { fixed = false, max = 0 }; };
+template<> struct WireSize<std::string> { enum { fixed = false, max = 0 }; };
+template<> struct WireSize<std::wstring> { enum { fixed = false, max = 0 }; };
+
+template<typename Args> struct PayloadSize;
+
+template<> struct PayloadSize<std::tuple<> >
+{
+	enum { fixed = true, max = sizeof(PipeMessages) };
+};
+
+template<typename T, typename ...Rest> struct PayloadSize<std::tuple<T, Rest...> >
+{
+	enum
+	{
+		fixed = WireSize<T>::fixed && PayloadSize<std::tuple<Rest...> >::fixed,
+		max = WireSize<T>::max + PayloadSize<std::tuple<Rest...> >::max
+	};
+};
+
+// Size of a message with all of its fields, only meaningful if 'fixed' is set
+template<PipeMessages M> struct MessageSize : PayloadSize<typename MessageSchema<M>::Args> {};
+
+// Compile time index list, used to unpack decoded arguments into a handler call
+template<size_t ...I> struct IndexList {};
+
+template<size_t N, size_t ...I> struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+template<size_t ...I> struct MakeIndexList<0, I...> { typedef IndexList<I...> type; };
+
+template<typename Args> struct MessageCodec;
+
+template<typename ...T> struct MessageCodec<std::tuple<T...> >
+{
+	template<typename ...A>
+	static void encode(Serializer& serializer, A&&... args)
+	{
+		static_assert(sizeof...(A) == sizeof...(T), "Argument count doesn't match the message schema");
+
+		int expand[] = { 0, ((serializer << static_cast<T>(std::forward<A>(args))), 0)... };
+		(void) expand;
+	}
+
+	static void decode(Serializer& serializer, std::tuple<T...>& args)
+	{
+		decode(serializer, args, typename MakeIndexList<sizeof...(T)>::type());
+	}
+
+private:
+	template<size_t ...I>
+	static void decode(Serializer& serializer, std::tuple<T...>& args, IndexList<I...>)
+	{
+		int expand[] = { 0, ((serializer >> std::get<I>(args)), 0)... };
+		(void) expand;
+	}
+};
+
+template<PipeMessages M, typename ...A>
+void encodeMessage(Serializer& serializer, A&&... args)
+{
+	serializer << M;
+	MessageCodec<typename MessageSchema<M>::Args>::encode(serializer, std::forward<A>(args)...);
+}
+
+// Like encodeMessage(), but the server handles the message without sending a reply
+template<PipeMessages M, typename ...A>
+void encodeOneWayMessage(Serializer& serializer, A&&... args)
+{
+	static_assert(IsSetter<M>::value, "Only setters can be sent one-way");
+
+	serializer << PipeMessages(short(M) | PROTOCOL_ONE_WAY_FLAG);
+	MessageCodec<typename MessageSchema<M>::Args>::encode(serializer, std::forward<A>(args)...);
+}
+
+// Like encodeMessage(), but the server repeats 'requestId' at the start of the reply, so that
+// several requests can be in flight on one connection
+template<PipeMessages M, typename ...A>
+void encodeTaggedMessage(Serializer& serializer, unsigned int requestId, A&&... args)
+{
+	serializer << PipeMessages(short(M) | PROTOCOL_REQUEST_ID_FLAG) << requestId;
+	MessageCodec<typename MessageSchema<M>::Args>::encode(serializer, std::forward<A>(args)...);
+}
+
+template<PipeMessages M>
+void decodeMessage(Serializer& serializer, typename MessageSchema<M>::Args& args)
+{
+	MessageCodec<typename MessageSchema<M>::Args>::decode(serializer, args);
+}
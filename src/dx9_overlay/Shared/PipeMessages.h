@@ -4,16 +4,18 @@ enum class PipeMessages : short
 {
 	Ping = 1,
 	TextCreate,
-	TextCreateUnicode,
+	// Retired with the UTF-16 variants, text is always UTF-8 now. The ids stay reserved so that
+	// the following ones keep their values.
+	ReservedTextCreateUnicode,
 	TextDestroy,
 	TextSetShadow,
 	TextSetShown,
 	TextSetColor,
 	TextSetPos,
 	TextSetString,
-	TextSetStringUnicode,
+	ReservedTextSetStringUnicode,
 	TextUpdate,
-	TextUpdateUnicode,
+	ReservedTextUpdateUnicode,
 	BoxCreate,
 	BoxDestroy,
 	BoxSetShown,
@@ -41,5 +43,18 @@ enum class PipeMessages : short
 	GetFrameRate,
 	GetScreenSpecs,
 	SetCalculationRatio,
-	SetOverlayPriority
+	SetOverlayPriority,
+	Handshake,
+	StringIntern,
+	TextCreateInterned,
+	TextUpdateInterned,
+	OpenSharedMemory,
+	Sync,
+	Batch,
+	GetCoalescedUpdates,
+	BulkUpdate,
+	StringRelease,
+
+	// Keep last, new messages are added above
+	Count
 };
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+
+// Bumped whenever the wire format changes in an incompatible way. The Handshake message and
+// ServerInfo must stay the same in every version, both sides refuse a session with another one.
+#define PROTOCOL_VERSION			2
+
+// Size of the fixed per-connection pipe buffers. Larger messages are streamed
+// through the message pipe in chunks of this size.
+#define PROTOCOL_CHUNK_SIZE			4096
+
+// Largest request or reply the server accepts
+#define PROTOCOL_MAX_MESSAGE_SIZE	(16 * 1024 * 1024)
+
+// Largest message on the event pipe, see OverlayEvent
+#define PROTOCOL_MAX_EVENT_SIZE		64
+
+// Set in the message id of requests which don't expect a reply (FeatureOneWay)
+#define PROTOCOL_ONE_WAY_FLAG		0x4000
+
+// Set in the message id of requests which are followed by a request id (FeaturePipelining).
+// The server repeats the id at the start of the reply.
+#define PROTOCOL_REQUEST_ID_FLAG	0x2000
+
+// Payload encodings understood by the server
+enum ProtocolEncoding
+{
+	EncodingBinary = 1 << 0
+};
+
+// Optional transport features, announced by the server in the handshake
+enum ProtocolFeature
+{
+	FeatureBatching = 1 << 0,
+	FeatureOneWay = 1 << 1,
+	FeatureSharedMemory = 1 << 2,
+	FeatureLargeMessages = 1 << 3,
+	FeatureStringInterning = 1 << 4,
+	FeaturePipelining = 1 << 5,
+	FeatureEvents = 1 << 6,
+	FeatureBulkUpdate = 1 << 7
+};
+
+// Properties set by the records of PipeMessages::BulkUpdate. Objects only accept the
+// properties they have, colors are sent as the bits of the D3DCOLOR.
+enum OverlayProperty
+{
+	PropertyShown = 1,
+	PropertyX,
+	PropertyY,
+	// End point of a Line
+	PropertyX2,
+	PropertyY2,
+	// Box, and the thickness of a Line
+	PropertyWidth,
+	PropertyHeight,
+	PropertyColor,
+	PropertyBorderShown,
+	PropertyBorderWidth,
+	PropertyBorderColor,
+	PropertyShadow,
+	PropertyRotation,
+	PropertyAlign,
+	PropertyPriority
+};
+
+// Events the server pushes to the clients connected to its event pipe (FeatureEvents).
+// Every event is one message: its id followed by two int values.
+enum OverlayEvent
+{
+	// Sent whenever the frame rate is measured: frames per second, average frame time in microseconds
+	EventFrameStats = 1 << 0,
+	// The size of the viewport changed: width, height
+	EventResolutionChanged = 1 << 1,
+	// The device has been reset, e.g. after it was lost
+	EventDeviceReset = 1 << 2,
+	// The resource of an object (font, texture) couldn't be loaded: object id
+	EventLoadFailed = 1 << 3
+};
+
+// Reply to PipeMessages::Handshake
+struct ServerInfo
+{
+	int protocolVersion;
+	int maxMessageSize;
+	unsigned int encodings;
+	unsigned int features;
+};
+
+// Checks the flag in the little-endian message id at the start of an encoded request
+inline bool isOneWayRequest(const char *data, size_t size)
+{
+	return size >= 2 && ((((unsigned char) data[1]) << 8) & PROTOCOL_ONE_WAY_FLAG) != 0;
+}
@@ -0,0 +1,225 @@
+#include "AsyncPipeClient.h"
+#include "PipeClient.h"
+
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <vector>
+
+static void fail(const AsyncPipeClient::Completion& completion)
+{
+	Serializer serializerOut;
+	completion(false, serializerOut);
+}
+
+AsyncPipeClient::AsyncPipeClient() : m_hPipe(INVALID_HANDLE_VALUE), m_thread(nullptr), m_bBroken(false), m_nextRequestId(1)
+{
+	m_hWriteEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	m_hReadEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	m_hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+}
+
+AsyncPipeClient::~AsyncPipeClient()
+{
+	close();
+
+	CloseHandle(m_hWriteEvent);
+	CloseHandle(m_hReadEvent);
+	CloseHandle(m_hStopEvent);
+}
+
+unsigned int AsyncPipeClient::nextRequestId()
+{
+	return m_nextRequestId++;
+}
+
+void AsyncPipeClient::send(Serializer& serializerIn, unsigned int requestId, const Completion& completion)
+{
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+
+	if (!open())
+		return fail(completion);
+
+	{
+		std::lock_guard<std::mutex> l(m_pendingMutex);
+
+		// The reader thread has already failed the pending requests, this one would never complete
+		if (m_bBroken)
+			return fail(completion);
+
+		// Registered before writing, the reply may arrive before WriteFile returns
+		m_pending[requestId] = completion;
+	}
+
+	if (write(serializerIn))
+		return;
+
+	Completion failed;
+	{
+		std::lock_guard<std::mutex> l(m_pendingMutex);
+
+		auto it = m_pending.find(requestId);
+		if (it == m_pending.end())
+			return;
+
+		failed = std::move(it->second);
+		m_pending.erase(it);
+	}
+
+	fail(failed);
+}
+
+void AsyncPipeClient::close()
+{
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+
+	closeConnection();
+}
+
+bool AsyncPipeClient::open()
+{
+	if (m_hPipe != INVALID_HANDLE_VALUE && !m_bBroken)
+		return true;
+
+	closeConnection();
+
+	m_hPipe = PipeClient::connect(FILE_FLAG_OVERLAPPED);
+	if (m_hPipe == INVALID_HANDLE_VALUE)
+		return false;
+
+	m_bBroken = false;
+	ResetEvent(m_hStopEvent);
+
+	m_thread = new boost::thread(boost::bind(&AsyncPipeClient::readReplies, this));
+	return true;
+}
+
+void AsyncPipeClient::closeConnection()
+{
+	if (m_hPipe == INVALID_HANDLE_VALUE)
+		return;
+
+	// Ends the reader thread, it fails the requests which are left
+	SetEvent(m_hStopEvent);
+
+	if (m_thread)
+	{
+		if (m_thread->joinable())
+			m_thread->join();
+
+		delete m_thread;
+		m_thread = nullptr;
+	}
+
+	CloseHandle(m_hPipe);
+	m_hPipe = INVALID_HANDLE_VALUE;
+}
+
+bool AsyncPipeClient::write(Serializer& serializerIn)
+{
+	OVERLAPPED overlapped = { 0 };
+	overlapped.hEvent = m_hWriteEvent;
+
+	DWORD dwWritten = 0;
+	BOOL bSuccess = WriteFile(m_hPipe, serializerIn.data(), serializerIn.numberOfBytesUsed(), &dwWritten, &overlapped);
+	if (!bSuccess && GetLastError() == ERROR_IO_PENDING)
+		bSuccess = GetOverlappedResult(m_hPipe, &overlapped, &dwWritten, TRUE);
+
+	return bSuccess && dwWritten == (DWORD) serializerIn.numberOfBytesUsed();
+}
+
+bool AsyncPipeClient::read(Serializer& serializerOut)
+{
+	serializerOut.clear();
+
+	char *szData = serializerOut.prepareBuffer(BUFSIZE);
+	DWORD dwCapacity = BUFSIZE;
+	size_t size = 0;
+
+	while (true)
+	{
+		OVERLAPPED overlapped = { 0 };
+		overlapped.hEvent = m_hReadEvent;
+
+		DWORD dwRead = 0;
+		BOOL bSuccess = ReadFile(m_hPipe, szData, dwCapacity, &dwRead, &overlapped);
+		if (!bSuccess && GetLastError() == ERROR_IO_PENDING)
+		{
+			HANDLE hEvents[2] = { m_hReadEvent, m_hStopEvent };
+			if (WaitForMultipleObjects(2, hEvents, FALSE, INFINITE) != WAIT_OBJECT_0)
+			{
+				// The read has to be finished before its buffer and the handle go away
+				CancelIoEx(m_hPipe, &overlapped);
+				GetOverlappedResult(m_hPipe, &overlapped, &dwRead, TRUE);
+				return false;
+			}
+
+			bSuccess = GetOverlappedResult(m_hPipe, &overlapped, &dwRead, FALSE);
+		}
+
+		size += dwRead;
+
+		if (bSuccess)
+		{
+			serializerOut.commitBuffer(size);
+			return true;
+		}
+
+		// Replies larger than one chunk are continued until the whole message has been read
+		if (GetLastError() != ERROR_MORE_DATA)
+			return false;
+
+		DWORD dwLeft = 0;
+		if (!PeekNamedPipe(m_hPipe, NULL, 0, NULL, NULL, &dwLeft) || size + dwLeft > PROTOCOL_MAX_MESSAGE_SIZE)
+			return false;
+
+		dwCapacity = std::max<DWORD>(dwLeft, BUFSIZE);
+
+		serializerOut.commitBuffer(size);
+		szData = serializerOut.extendBuffer(dwCapacity);
+	}
+}
+
+void AsyncPipeClient::readReplies()
+{
+	Serializer serializerOut;
+
+	while (read(serializerOut))
+	{
+		SERIALIZATION_READ(serializerOut, unsigned int, requestId);
+
+		Completion completion;
+		{
+			std::lock_guard<std::mutex> lock(m_pendingMutex);
+
+			auto it = m_pending.find(requestId);
+			if (it == m_pending.end())
+				continue;
+
+			completion = std::move(it->second);
+			m_pending.erase(it);
+		}
+
+		completion(true, serializerOut);
+	}
+
+	failPending();
+}
+
+void AsyncPipeClient::failPending()
+{
+	std::vector<Completion> failed;
+	{
+		std::lock_guard<std::mutex> lock(m_pendingMutex);
+
+		m_bBroken = true;
+
+		for (auto it = m_pending.begin(); it != m_pending.end(); it++)
+			failed.push_back(std::move(it->second));
+
+		m_pending.clear();
+	}
+
+	for (size_t i = 0; i < failed.size(); i++)
+		fail(failed[i]);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "Windows.h"
+#include "Serializer.h"
+
+#include <Shared/Protocol.h>
+
+#include <functional>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+
+namespace boost { class thread; }
+
+// One pipe connection with many requests in flight (FeaturePipelining). Every request carries
+// an id which the server repeats at the start of its reply, a reader thread hands each reply
+// to the completion which was registered for that id.
+class AsyncPipeClient
+{
+public:
+	// Called exactly once per request: from the reader thread with the reply behind the request id,
+	// or with bSuccess == false if the request couldn't be sent or the connection broke.
+	// Completions must not send requests themselves.
+	typedef std::function<void(bool bSuccess, Serializer& serializerOut)> Completion;
+
+	AsyncPipeClient();
+	~AsyncPipeClient();
+
+	unsigned int nextRequestId();
+
+	// Sends a request encoded with encodeTaggedMessage(), the connection is opened on first use
+	void send(Serializer& serializerIn, unsigned int requestId, const Completion& completion);
+
+	// Fails all requests which are still in flight
+	void close();
+
+private:
+	AsyncPipeClient(const AsyncPipeClient&);
+	AsyncPipeClient& operator=(const AsyncPipeClient&);
+
+	bool open();
+	void closeConnection();
+
+	bool write(Serializer& serializerIn);
+	bool read(Serializer& serializerOut);
+	void readReplies();
+	void failPending();
+
+	HANDLE m_hPipe;
+	HANDLE m_hWriteEvent, m_hReadEvent, m_hStopEvent;
+	boost::thread *m_thread;
+
+	// Set by the reader thread once the connection broke, the next send() opens a new one
+	std::atomic<bool> m_bBroken;
+
+	std::unordered_map<unsigned int, Completion> m_pending;
+	std::mutex m_pendingMutex;
+
+	// Serializes the writes, open() and close()
+	std::mutex m_writeMutex;
+
+	std::atomic<unsigned int> m_nextRequestId;
+};
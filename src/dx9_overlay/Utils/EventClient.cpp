@@ -0,0 +1,163 @@
+#include "EventClient.h"
+#include "Serializer.h"
+
+#include <Shared/Config.h>
+
+#include <boost/thread.hpp>
+
+EventClient::EventClient() : m_hPipe(INVALID_HANDLE_VALUE), m_thread(nullptr), m_mask(0), m_bConnected(false)
+{
+	m_hReadEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	m_hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+}
+
+EventClient::~EventClient()
+{
+	close();
+
+	CloseHandle(m_hReadEvent);
+	CloseHandle(m_hStopEvent);
+}
+
+bool EventClient::subscribe(int mask)
+{
+	std::lock_guard<std::mutex> lock(m_mtx);
+
+	m_mask = mask;
+
+	if (m_bConnected)
+		return true;
+
+	closeConnection();
+
+	char szPipe[MAX_PATH + 1] = { 0 };
+	sprintf_s(szPipe, "\\\\.\\pipe\\%s", g_strEventPipeName);
+
+	// FILE_WRITE_ATTRIBUTES is needed to switch the read-only end to message mode
+	m_hPipe = CreateFileA(szPipe, GENERIC_READ | FILE_WRITE_ATTRIBUTES, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+	if (m_hPipe == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD dwMode = PIPE_READMODE_MESSAGE;
+	if (!SetNamedPipeHandleState(m_hPipe, &dwMode, NULL, NULL))
+	{
+		CloseHandle(m_hPipe);
+		m_hPipe = INVALID_HANDLE_VALUE;
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> l(m_eventsMutex);
+		m_events.clear();
+	}
+
+	m_bConnected = true;
+	ResetEvent(m_hStopEvent);
+
+	m_thread = new boost::thread(boost::bind(&EventClient::readEvents, this));
+	return true;
+}
+
+bool EventClient::next(Event& event, DWORD dwTimeout)
+{
+	std::unique_lock<std::mutex> lock(m_eventsMutex);
+
+	m_eventsCond.wait_for(lock, std::chrono::milliseconds(dwTimeout), [this]() {
+		return !m_events.empty() || !m_bConnected;
+	});
+
+	if (m_events.empty())
+		return false;
+
+	event = m_events.front();
+	m_events.pop_front();
+	return true;
+}
+
+bool EventClient::isConnected() const
+{
+	return m_bConnected;
+}
+
+void EventClient::close()
+{
+	std::lock_guard<std::mutex> lock(m_mtx);
+
+	closeConnection();
+}
+
+void EventClient::closeConnection()
+{
+	if (m_hPipe == INVALID_HANDLE_VALUE)
+		return;
+
+	SetEvent(m_hStopEvent);
+
+	if (m_thread)
+	{
+		if (m_thread->joinable())
+			m_thread->join();
+
+		delete m_thread;
+		m_thread = nullptr;
+	}
+
+	CloseHandle(m_hPipe);
+	m_hPipe = INVALID_HANDLE_VALUE;
+}
+
+void EventClient::readEvents()
+{
+	char szEvent[PROTOCOL_MAX_EVENT_SIZE];
+
+	while (true)
+	{
+		OVERLAPPED overlapped = { 0 };
+		overlapped.hEvent = m_hReadEvent;
+
+		DWORD dwRead = 0;
+		BOOL bSuccess = ReadFile(m_hPipe, szEvent, sizeof(szEvent), &dwRead, &overlapped);
+		if (!bSuccess && GetLastError() == ERROR_IO_PENDING)
+		{
+			HANDLE hEvents[2] = { m_hReadEvent, m_hStopEvent };
+			if (WaitForMultipleObjects(2, hEvents, FALSE, INFINITE) != WAIT_OBJECT_0)
+			{
+				// The read has to be finished before its buffer and the handle go away
+				CancelIoEx(m_hPipe, &overlapped);
+				GetOverlappedResult(m_hPipe, &overlapped, &dwRead, TRUE);
+				break;
+			}
+
+			bSuccess = GetOverlappedResult(m_hPipe, &overlapped, &dwRead, FALSE);
+		}
+
+		if (!bSuccess)
+			break;
+
+		Event event = { 0 };
+
+		Serializer serializer(szEvent, dwRead);
+		serializer >> event.event >> event.value1 >> event.value2;
+
+		if ((event.event & m_mask) == 0)
+			continue;
+
+		{
+			std::lock_guard<std::mutex> lock(m_eventsMutex);
+
+			if (m_events.size() >= EVENT_QUEUE_LIMIT)
+				m_events.pop_front();
+
+			m_events.push_back(event);
+		}
+
+		m_eventsCond.notify_one();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_eventsMutex);
+		m_bConnected = false;
+	}
+
+	m_eventsCond.notify_all();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "Windows.h"
+
+#include <Shared/Protocol.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#define EVENT_QUEUE_LIMIT	64
+
+namespace boost { class thread; }
+
+// Connection to the server's event pipe (FeatureEvents). A reader thread keeps the events
+// the client subscribed to until they are taken with next(), nothing is sent to the server.
+class EventClient
+{
+public:
+	struct Event
+	{
+		int event;
+		int value1;
+		int value2;
+	};
+
+	EventClient();
+	~EventClient();
+
+	// Connects on first use, afterwards only the mask of OverlayEvents is replaced.
+	// Returns false if the server's event pipe can't be opened.
+	bool subscribe(int mask);
+
+	// Waits up to dwTimeout ms for an event. False if none arrived or the connection is closed.
+	bool next(Event& event, DWORD dwTimeout);
+
+	bool isConnected() const;
+
+	void close();
+
+private:
+	EventClient(const EventClient&);
+	EventClient& operator=(const EventClient&);
+
+	void closeConnection();
+	void readEvents();
+
+	HANDLE m_hPipe;
+	HANDLE m_hReadEvent, m_hStopEvent;
+	boost::thread *m_thread;
+
+	std::atomic<int> m_mask;
+	std::atomic<bool> m_bConnected;
+
+	std::deque<Event> m_events;
+	std::mutex m_eventsMutex;
+	std::condition_variable m_eventsCond;
+
+	// Serializes subscribe() and close()
+	std::mutex m_mtx;
+};
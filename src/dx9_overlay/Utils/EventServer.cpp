@@ -0,0 +1,227 @@
+#include "EventServer.h"
+#include "Serializer.h"
+
+#include <Shared/Config.h>
+
+#include <boost/thread.hpp>
+
+// Completion keys, the pipes themselves are associated with EVENT_KEY_PIPE
+#define EVENT_KEY_PIPE		0
+#define EVENT_KEY_PUBLISH	1
+#define EVENT_KEY_STOP		2
+
+EventServer::EventServer() : m_hPort(NULL), m_thread(nullptr)
+{
+	memset(m_szPipe, 0, sizeof(m_szPipe));
+
+	sprintf_s(m_szPipe, "\\\\.\\pipe\\%s", g_strEventPipeName);
+
+	m_hPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+	if (m_hPort == NULL)
+		return;
+
+	listen();
+
+	m_thread = new boost::thread(boost::bind(&EventServer::thread, this));
+}
+
+EventServer::~EventServer()
+{
+	if (m_hPort == NULL)
+		return;
+
+	PostQueuedCompletionStatus(m_hPort, 0, EVENT_KEY_STOP, NULL);
+
+	if (m_thread)
+	{
+		if (m_thread->joinable())
+			m_thread->join();
+
+		delete m_thread;
+	}
+
+	for (size_t i = 0; i < m_subscribers.size(); i++)
+		CloseHandle(m_subscribers[i]->hPipe);
+
+	m_subscribers.clear();
+	CloseHandle(m_hPort);
+}
+
+void EventServer::publish(OverlayEvent event, int value1, int value2)
+{
+	Serializer serializer;
+	serializer << int(event) << value1 << value2;
+
+	bool bWakeUp = false;
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		if (m_published.size() >= EVENT_QUEUE_LIMIT)
+			m_published.pop_front();
+
+		m_published.push_back(std::string(serializer.data(), serializer.numberOfBytesUsed()));
+
+		// The thread takes all published events at once, one wake-up is enough
+		bWakeUp = m_published.size() == 1;
+	}
+
+	if (bWakeUp)
+		PostQueuedCompletionStatus(m_hPort, 0, EVENT_KEY_PUBLISH, NULL);
+}
+
+void EventServer::thread()
+{
+	while (true)
+	{
+		DWORD dwBytes = 0;
+		ULONG_PTR key = 0;
+		OVERLAPPED *overlapped = nullptr;
+
+		BOOL bSuccess = GetQueuedCompletionStatus(m_hPort, &dwBytes, &key, &overlapped, INFINITE);
+		if (overlapped == nullptr)
+		{
+			if (!bSuccess || key == EVENT_KEY_STOP)
+				return;
+
+			deliver();
+			continue;
+		}
+
+		Subscriber *subscriber = CONTAINING_RECORD(overlapped, Subscriber, overlapped);
+		complete(subscriber, bSuccess ? ERROR_SUCCESS : GetLastError());
+	}
+}
+
+// Keeps one instance waiting for the next client
+void EventServer::listen()
+{
+	HANDLE hPipe = CreateNamedPipeA(m_szPipe, PIPE_ACCESS_OUTBOUND | FILE_FLAG_OVERLAPPED, PIPE_TYPE_MESSAGE | PIPE_WAIT,
+		PIPE_UNLIMITED_INSTANCES, PROTOCOL_MAX_EVENT_SIZE * EVENT_QUEUE_LIMIT, 0, 0, NULL);
+
+	if (hPipe == INVALID_HANDLE_VALUE)
+		return;
+
+	if (CreateIoCompletionPort(hPipe, m_hPort, EVENT_KEY_PIPE, 0) == NULL)
+	{
+		CloseHandle(hPipe);
+		return;
+	}
+
+	std::unique_ptr<Subscriber> subscriber(new Subscriber);
+	memset(&subscriber->overlapped, 0, sizeof(OVERLAPPED));
+	subscriber->hPipe = hPipe;
+	subscriber->bConnected = subscriber->bWriting = false;
+
+	m_subscribers.push_back(std::move(subscriber));
+	Subscriber *listener = m_subscribers.back().get();
+
+	if (!ConnectNamedPipe(hPipe, &listener->overlapped))
+	{
+		switch (GetLastError())
+		{
+		case ERROR_IO_PENDING:
+			return;
+
+		// The client connected before ConnectNamedPipe was called, no completion is queued for it
+		case ERROR_PIPE_CONNECTED:
+			break;
+
+		default:
+			return close(listener);
+		}
+	}
+
+	connected(listener);
+}
+
+// Events published before a client connected aren't sent to it
+void EventServer::connected(Subscriber *subscriber)
+{
+	subscriber->bConnected = true;
+
+	listen();
+}
+
+void EventServer::complete(Subscriber *subscriber, DWORD dwError)
+{
+	if (!subscriber->bConnected)
+	{
+		if (dwError != ERROR_SUCCESS)
+		{
+			close(subscriber);
+			return listen();
+		}
+
+		return connected(subscriber);
+	}
+
+	subscriber->bWriting = false;
+
+	// The client has gone
+	if (dwError != ERROR_SUCCESS)
+		return close(subscriber);
+
+	write(subscriber);
+}
+
+void EventServer::deliver()
+{
+	std::deque<std::string> events;
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		events.swap(m_published);
+	}
+
+	// Copied, write() may close a subscriber and remove it from the list
+	std::vector<Subscriber *> subscribers;
+	for (size_t i = 0; i < m_subscribers.size(); i++)
+	{
+		if (m_subscribers[i]->bConnected)
+			subscribers.push_back(m_subscribers[i].get());
+	}
+
+	for (size_t i = 0; i < subscribers.size(); i++)
+	{
+		Subscriber *subscriber = subscribers[i];
+
+		for (auto it = events.begin(); it != events.end(); it++)
+		{
+			if (subscriber->queue.size() >= EVENT_QUEUE_LIMIT)
+				subscriber->queue.pop_front();
+
+			subscriber->queue.push_back(*it);
+		}
+
+		if (!subscriber->bWriting)
+			write(subscriber);
+	}
+}
+
+// Starts writing the next queued event, every subscriber has at most one write in flight
+void EventServer::write(Subscriber *subscriber)
+{
+	if (subscriber->queue.empty())
+		return;
+
+	subscriber->writing.swap(subscriber->queue.front());
+	subscriber->queue.pop_front();
+	subscriber->bWriting = true;
+
+	// Writes which finish at once are queued to the completion port as well
+	if (!WriteFile(subscriber->hPipe, subscriber->writing.data(), (DWORD) subscriber->writing.size(), NULL, &subscriber->overlapped) && GetLastError() != ERROR_IO_PENDING)
+		close(subscriber);
+}
+
+void EventServer::close(Subscriber *subscriber)
+{
+	CloseHandle(subscriber->hPipe);
+
+	for (auto it = m_subscribers.begin(); it != m_subscribers.end(); it++)
+	{
+		if (it->get() == subscriber)
+		{
+			m_subscribers.erase(it);
+			break;
+		}
+	}
+}
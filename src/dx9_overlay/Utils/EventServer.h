@@ -0,0 +1,61 @@
+#pragma once
+#include "Windows.h"
+
+#include <Shared/Protocol.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define EVENT_QUEUE_LIMIT	64
+
+namespace boost { class thread; }
+
+// Pushes events to every client connected to the event pipe. A single thread does all of the
+// pipe I/O through a completion port, so publish() never waits for a client. Clients which
+// don't read their events lose the oldest ones once EVENT_QUEUE_LIMIT of them are waiting.
+class EventServer
+{
+	struct Subscriber
+	{
+		OVERLAPPED	overlapped;
+		HANDLE		hPipe;
+		bool		bConnected,
+					bWriting;
+
+		// The event of the write in flight, the queue may change while it is written
+		std::string				writing;
+		std::deque<std::string>	queue;
+	};
+
+public:
+	EventServer();
+	~EventServer();
+
+	// Can be called from any thread
+	void publish(OverlayEvent event, int value1, int value2);
+
+private:
+	void thread();
+
+	void listen();
+	void connected(Subscriber *subscriber);
+	void complete(Subscriber *subscriber, DWORD dwError);
+	void deliver();
+	void write(Subscriber *subscriber);
+	void close(Subscriber *subscriber);
+
+	HANDLE m_hPort;
+	char m_szPipe[MAX_PATH];
+
+	// Only used by the thread
+	std::vector<std::unique_ptr<Subscriber> > m_subscribers;
+
+	// Events which haven't been handed to the thread yet
+	std::deque<std::string> m_published;
+	std::mutex m_mtx;
+
+	boost::thread *m_thread;
+};
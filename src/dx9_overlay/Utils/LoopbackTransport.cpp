@@ -0,0 +1,141 @@
+#include "LoopbackTransport.h"
+
+#include <boost/thread.hpp>
+
+LoopbackTransport::LoopbackTransport(MessageCallback callback) : m_cbCallback(callback), m_bStop(false), m_iWaiting(0), m_thread(nullptr)
+{
+	m_thread = new boost::thread(boost::bind(&LoopbackTransport::thread, this));
+}
+
+LoopbackTransport::~LoopbackTransport()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_bStop = true;
+	}
+
+	m_requestReady.notify_all();
+
+	if (m_thread->joinable())
+		m_thread->join();
+
+	delete m_thread;
+
+	// The thread has stopped, the requests it didn't take fail
+	std::unique_lock<std::mutex> lock(m_mtx);
+
+	for (auto request : m_queue)
+	{
+		if (request->reply)
+			request->done = true;
+		else
+			delete request;
+	}
+
+	m_queue.clear();
+	m_replyReady.notify_all();
+
+	// The requests of transact() live on the callers' stacks
+	while (m_iWaiting > 0)
+		m_replyReady.wait(lock);
+}
+
+bool LoopbackTransport::transact(Serializer& serializerIn, Serializer& serializerOut)
+{
+	Request request;
+	request.data.assign(serializerIn.data(), serializerIn.data() + serializerIn.numberOfBytesUsed());
+	request.reply = &serializerOut;
+	request.done = false;
+	request.bSuccess = false;
+
+	serializerOut.clear();
+
+	std::unique_lock<std::mutex> lock(m_mtx);
+	if (m_bStop)
+		return false;
+
+	m_queue.push_back(&request);
+	m_iWaiting++;
+	m_requestReady.notify_one();
+
+	// Completed by the thread, or failed once the transport is stopped
+	while (!request.done)
+		m_replyReady.wait(lock);
+
+	if (--m_iWaiting == 0 && m_bStop)
+		m_replyReady.notify_all();
+
+	return request.bSuccess;
+}
+
+bool LoopbackTransport::post(Serializer& serializerIn)
+{
+	Request *request = new Request;
+	request->data.assign(serializerIn.data(), serializerIn.data() + serializerIn.numberOfBytesUsed());
+	request->reply = nullptr;
+	request->done = false;
+	request->bSuccess = false;
+
+	if (enqueue(request))
+		return true;
+
+	delete request;
+	return false;
+}
+
+bool LoopbackTransport::enqueue(Request *request)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		if (m_bStop)
+			return false;
+
+		m_queue.push_back(request);
+	}
+
+	m_requestReady.notify_one();
+	return true;
+}
+
+void LoopbackTransport::thread()
+{
+	// Replies of one-way requests are written here and dropped
+	Serializer discarded;
+
+	while (true)
+	{
+		Request *request = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_mtx);
+			while (m_queue.empty() && !m_bStop)
+				m_requestReady.wait(lock);
+
+			// The destructor fails what is left in the queue
+			if (m_bStop)
+				break;
+
+			request = m_queue.front();
+			m_queue.pop_front();
+		}
+
+		Serializer serializerIn(request->data.empty() ? nullptr : &request->data[0], (unsigned int) request->data.size());
+		Serializer& serializerOut = request->reply ? *request->reply : discarded;
+
+		discarded.clear();
+		m_cbCallback(serializerIn, serializerOut);
+
+		if (!request->reply)
+		{
+			delete request;
+			continue;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			request->bSuccess = true;
+			request->done = true;
+		}
+
+		m_replyReady.notify_all();
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "Transport.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace boost { class thread; }
+
+// Hands requests to a MessageCallback in the same process, without a pipe or a game.
+// Requests are copied and handled one at a time by a worker thread, like the server does,
+// so the client -> Serializer -> dispatch path can be driven and measured on its own.
+//
+// Destroying the transport stops after the request which is being handled, the queued ones fail.
+// It must not be destroyed while a transact() or post() is being called.
+class LoopbackTransport : public Transport
+{
+	struct Request
+	{
+		std::vector<char> data;
+		Serializer *reply;
+		bool done, bSuccess;
+	};
+
+public:
+	LoopbackTransport(MessageCallback callback);
+	~LoopbackTransport();
+
+	bool transact(Serializer& serializerIn, Serializer& serializerOut) override;
+	bool post(Serializer& serializerIn) override;
+
+private:
+	LoopbackTransport(const LoopbackTransport&);
+	LoopbackTransport& operator=(const LoopbackTransport&);
+
+	bool enqueue(Request *request);
+	void thread();
+
+	MessageCallback m_cbCallback;
+
+	std::deque<Request *> m_queue;
+	std::mutex m_mtx;
+	std::condition_variable m_requestReady, m_replyReady;
+	bool m_bStop;
+
+	// Callers of transact() which wait for their reply
+	int m_iWaiting;
+
+	boost::thread *m_thread;
+};
@@ -0,0 +1,184 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <utility>
+
+// Unbounded multi-producer/single-consumer queue (Vyukov's intrusive queue). push() may be
+// called from any thread, pop() only from the consumer. Neither waits for the other side.
+// A producer which has been preempted in the middle of push() hides the values pushed after
+// its own until it continues, pop() reports the queue as empty meanwhile.
+//
+// Popped nodes are kept for later pushes, so the queue only allocates until it has as many
+// nodes as values were queued at once. pop() swaps the value out of its node: the node keeps
+// the consumer's previous value, e.g. a string whose buffer a producer can fill again.
+template<typename T>
+class MpscQueue
+{
+	struct Node
+	{
+		std::atomic<Node *> next;
+		T value;
+	};
+
+public:
+	// Values which are pushed at once, the consumer sees either none or all of them.
+	// A chain which has been appended to has to be pushed.
+	class Chain
+	{
+	public:
+		Chain() : _first(nullptr), _last(nullptr)
+		{
+		}
+
+		bool empty() const
+		{
+			return _first == nullptr;
+		}
+
+	private:
+		friend class MpscQueue;
+
+		Node *_first, *_last;
+	};
+
+	MpscQueue() : _head(&_stub), _tail(&_stub), _free(nullptr)
+	{
+		_stub.next.store(nullptr);
+	}
+
+	~MpscQueue()
+	{
+		T value = T();
+		while (pop(value));
+
+		for (Node *node = _free.load(); node != nullptr;)
+		{
+			Node *next = node->next.load(std::memory_order_relaxed);
+			delete node;
+			node = next;
+		}
+	}
+
+	void push(T value)
+	{
+		Chain chain;
+		append(chain) = std::move(value);
+		push(chain);
+	}
+
+	// Producer: adds a value to the end of the chain and returns it to be filled in. It still
+	// holds what a consumer left in the node, every member has to be assigned.
+	T& append(Chain& chain)
+	{
+		Node *node = allocate();
+		node->next.store(nullptr, std::memory_order_relaxed);
+
+		if (chain._last)
+			chain._last->next.store(node, std::memory_order_relaxed);
+		else
+			chain._first = node;
+
+		chain._last = node;
+		return node->value;
+	}
+
+	// Producer: queues the values of the chain behind each other, the chain is empty afterwards
+	void push(Chain& chain)
+	{
+		if (chain.empty())
+			return;
+
+		link(chain._first, chain._last);
+		chain._first = chain._last = nullptr;
+	}
+
+	// Consumer: takes the oldest value, false if there is none
+	bool pop(T& value)
+	{
+		Node *tail = _tail;
+		Node *next = tail->next.load(std::memory_order_acquire);
+
+		// The stub only keeps the list from becoming empty, skip it
+		if (tail == &_stub)
+		{
+			if (next == nullptr)
+				return false;
+
+			_tail = next;
+			tail = next;
+			next = next->next.load(std::memory_order_acquire);
+		}
+
+		if (next == nullptr)
+		{
+			// A producer has swapped the head but not linked its node yet
+			if (tail != _head.load(std::memory_order_acquire))
+				return false;
+
+			// The last node can only be taken once another one follows it
+			_stub.next.store(nullptr, std::memory_order_relaxed);
+			link(&_stub, &_stub);
+
+			next = tail->next.load(std::memory_order_acquire);
+			if (next == nullptr)
+				return false;
+		}
+
+		_tail = next;
+
+		using std::swap;
+		swap(value, tail->value);
+
+		release(tail);
+		return true;
+	}
+
+private:
+	MpscQueue(const MpscQueue&);
+	MpscQueue& operator=(const MpscQueue&);
+
+	// Nodes linked from 'first' to 'last' become visible with the store to prev->next
+	void link(Node *first, Node *last)
+	{
+		Node *prev = _head.exchange(last, std::memory_order_acq_rel);
+		prev->next.store(first, std::memory_order_release);
+	}
+
+	// Producer: takes a node the consumer has released. Only one producer at a time takes nodes,
+	// so the node on top can't be taken and put back while the next one is read.
+	Node *allocate()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_freeMtx);
+
+			Node *node = _free.load(std::memory_order_acquire);
+			while (node && !_free.compare_exchange_weak(node, node->next.load(std::memory_order_relaxed), std::memory_order_acquire))
+				;
+
+			if (node)
+				return node;
+		}
+
+		return new Node;
+	}
+
+	// Consumer: puts a popped node back, never waits for the producers
+	void release(Node *node)
+	{
+		Node *top = _free.load(std::memory_order_relaxed);
+		do
+		{
+			node->next.store(top, std::memory_order_relaxed);
+		} while (!_free.compare_exchange_weak(top, node, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	// Written by the producers
+	std::atomic<Node *> _head;
+	// Only used by the consumer
+	Node *_tail;
+	Node _stub;
+
+	// Released nodes, put back by the consumer and taken by the producers
+	std::atomic<Node *> _free;
+	std::mutex _freeMtx;
+};
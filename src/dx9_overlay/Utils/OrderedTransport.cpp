@@ -0,0 +1,65 @@
+#include "OrderedTransport.h"
+
+#include <Shared/MessageSchema.h>
+
+#include <cstring>
+
+OrderedTransport::OrderedTransport(Transport& queue, QueueLimit queueLimit, std::mutex& queueMutex, Transport& fallback)
+	: m_queue(queue), m_queueLimit(queueLimit), m_queueMutex(queueMutex), m_fallback(fallback)
+{
+}
+
+bool OrderedTransport::transact(Serializer& serializerIn, Serializer& serializerOut)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+
+		uint32_t limit = m_queueLimit();
+
+		// Once a request is in the queue it must not be repeated through the fallback, even if its reply is lost
+		if (limit != 0 && (uint32_t) serializerIn.numberOfBytesUsed() <= limit)
+			return m_queue.transact(serializerIn, serializerOut);
+
+		if (limit != 0 && !drain())
+			return false;
+	}
+
+	return m_fallback.transact(serializerIn, serializerOut);
+}
+
+bool OrderedTransport::post(Serializer& serializerIn)
+{
+	uint32_t size = (uint32_t) serializerIn.numberOfBytesUsed();
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+
+		uint32_t limit = m_queueLimit();
+		if (limit == 0)
+			return m_fallback.post(serializerIn);
+
+		if (size <= limit)
+			return m_queue.post(serializerIn);
+
+		if (!drain())
+			return false;
+	}
+
+	// The same message without PROTOCOL_ONE_WAY_FLAG, the server answers it once it has been handled
+	Serializer request;
+	char *data = request.prepareBuffer(size);
+	memcpy(data, serializerIn.data(), size);
+	data[1] &= ~(PROTOCOL_ONE_WAY_FLAG >> 8);
+	request.commitBuffer(size);
+
+	Serializer reply;
+	return m_fallback.transact(request, reply);
+}
+
+bool OrderedTransport::drain()
+{
+	Serializer ping, reply;
+	encodeMessage<PipeMessages::Ping>(ping);
+
+	return m_queue.transact(ping, reply);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "Transport.h"
+
+#include <boost/function.hpp>
+
+#include <cstdint>
+#include <mutex>
+
+// Sends requests through a queue which only takes messages up to a size, e.g. a SharedMemoryChannel,
+// and larger ones through another transport. The server handles both at the same time, so a message
+// which goes the other way would overtake the ones still queued. It is only sent once the queue has
+// been drained by a Ping, and a one-way message is sent as a request there, so that the next queued
+// one can't overtake it either. The failure of such a message isn't counted for the next Sync.
+class OrderedTransport : public Transport
+{
+public:
+	// Largest message the queue takes right now, 0 while it is closed
+	typedef boost::function<uint32_t()> QueueLimit;
+
+	// 'queueMutex' is held while the queue is used, the fallback is used without it
+	OrderedTransport(Transport& queue, QueueLimit queueLimit, std::mutex& queueMutex, Transport& fallback);
+
+	bool transact(Serializer& serializerIn, Serializer& serializerOut) override;
+	bool post(Serializer& serializerIn) override;
+
+private:
+	OrderedTransport(const OrderedTransport&);
+	OrderedTransport& operator=(const OrderedTransport&);
+
+	// Waits until the server has handled every queued message, fails if the queue is lost
+	bool drain();
+
+	Transport& m_queue;
+	QueueLimit m_queueLimit;
+	std::mutex& m_queueMutex;
+	Transport& m_fallback;
+};
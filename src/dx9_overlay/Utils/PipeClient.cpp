@@ -4,25 +4,177 @@
 
 #include <Shared/Config.h>
 
+#include <algorithm>
 #include <iostream>
 
+std::vector<HANDLE> PipeClient::_idle;
+std::mutex PipeClient::_mtx;
+
+HANDLE PipeClient::connect(DWORD dwFlagsAndAttributes)
+{
+	char szPipe[MAX_PATH + 1] = { 0 };
+	sprintf_s(szPipe, "\\\\.\\pipe\\%s", g_strPipeName);
+
+	HANDLE hPipe = CreateFileA(szPipe, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, dwFlagsAndAttributes, NULL);
+
+	if (hPipe == INVALID_HANDLE_VALUE && GetLastError() == ERROR_PIPE_BUSY && WaitNamedPipeA(szPipe, TIME_OUT))
+		hPipe = CreateFileA(szPipe, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, dwFlagsAndAttributes, NULL);
+
+	if (hPipe == INVALID_HANDLE_VALUE)
+		return INVALID_HANDLE_VALUE;
+
+	DWORD dwMode = PIPE_READMODE_MESSAGE;
+	if (!SetNamedPipeHandleState(hPipe, &dwMode, NULL, NULL))
+	{
+		CloseHandle(hPipe);
+		return INVALID_HANDLE_VALUE;
+	}
+
+	return hPipe;
+}
+
+// Errors of a connection which the server has closed before the request was written
+static bool isDisconnected(DWORD dwError)
+{
+	return dwError == ERROR_BROKEN_PIPE || dwError == ERROR_NO_DATA || dwError == ERROR_PIPE_NOT_CONNECTED;
+}
+
 PipeClient::PipeClient(Serializer& serializerIn, Serializer& serializerOut) :
 m_bSuccess(false)
 {
-	char szData[BUFSIZE] = { 0 };
-	char szPipe[MAX_PATH + 1] = { 0 };
-	DWORD dwReaded;
+	m_bSuccess = send(serializerIn, &serializerOut);
+}
 
-	sprintf_s(szPipe, "\\\\.\\pipe\\%s", g_strPipeName);
+bool PipeClient::post(Serializer& serializerIn)
+{
+	return send(serializerIn, nullptr);
+}
 
-	if (CallNamedPipe(szPipe, (LPVOID)serializerIn.data(), serializerIn.numberOfBytesUsed(), szData, sizeof(szData), &dwReaded, TIME_OUT))
+bool PipeClient::send(Serializer& serializerIn, Serializer *serializerOut)
+{
+	// An idle connection may have been closed by the server in the meantime,
+	// in that case the request is repeated once on a new connection
+	for (int i = 0; i < 2; i++)
 	{
-		serializerOut.setData(szData, sizeof(szData));
-		m_bSuccess = true;
+		bool bReused = false;
+		HANDLE hPipe = acquireConnection(bReused);
+		if (hPipe == INVALID_HANDLE_VALUE)
+			return false;
+
+		DWORD dwError = ERROR_SUCCESS;
+		if (serializerOut ? transact(hPipe, serializerIn, *serializerOut, dwError) : write(hPipe, serializerIn, dwError))
+		{
+			releaseConnection(hPipe);
+			return true;
+		}
+
+		CloseHandle(hPipe);
+
+		if (!bReused || !isDisconnected(dwError))
+			return false;
 	}
+
+	return false;
 }
 
 bool PipeClient::success() const
 {
 	return m_bSuccess;
-}
\ No newline at end of file
+}
+
+void PipeClient::closeConnections()
+{
+	std::lock_guard<std::mutex> l(_mtx);
+
+	for (size_t i = 0; i < _idle.size(); i++)
+		CloseHandle(_idle[i]);
+
+	_idle.clear();
+}
+
+// The most recently used connection is handed out first, so a single-threaded client always
+// talks over the same connection and its one-way messages are handled in order
+HANDLE PipeClient::acquireConnection(bool& bReused)
+{
+	{
+		std::lock_guard<std::mutex> l(_mtx);
+
+		if (!_idle.empty())
+		{
+			HANDLE hPipe = _idle.back();
+			_idle.pop_back();
+
+			bReused = true;
+			return hPipe;
+		}
+	}
+
+	bReused = false;
+	return connect(0);
+}
+
+void PipeClient::releaseConnection(HANDLE hPipe)
+{
+	{
+		std::lock_guard<std::mutex> l(_mtx);
+
+		if (_idle.size() < MAX_IDLE_CONNECTIONS)
+		{
+			_idle.push_back(hPipe);
+			return;
+		}
+	}
+
+	// Every open connection occupies one of the server's pipe instances
+	CloseHandle(hPipe);
+}
+
+bool PipeClient::write(HANDLE hPipe, Serializer& serializerIn, DWORD& dwError)
+{
+	DWORD dwWritten = 0;
+	if (!WriteFile(hPipe, serializerIn.data(), serializerIn.numberOfBytesUsed(), &dwWritten, NULL))
+	{
+		dwError = GetLastError();
+		return false;
+	}
+
+	return dwWritten == (DWORD) serializerIn.numberOfBytesUsed();
+}
+
+bool PipeClient::transact(HANDLE hPipe, Serializer& serializerIn, Serializer& serializerOut, DWORD& dwError)
+{
+	DWORD dwReaded = 0;
+
+	// The reply is read straight into serializerOut, only the bytes actually received become readable
+	char *szData = serializerOut.prepareBuffer(BUFSIZE);
+
+	// Requests of any size are written as one message, the server reads them in chunks
+	BOOL bSuccess = TransactNamedPipe(hPipe, (LPVOID)serializerIn.data(), serializerIn.numberOfBytesUsed(), szData, BUFSIZE, &dwReaded, NULL);
+	size_t size = dwReaded;
+
+	// Replies larger than one chunk are continued until the whole message has been read
+	while (!bSuccess && GetLastError() == ERROR_MORE_DATA)
+	{
+		DWORD dwLeft = 0;
+		if (!PeekNamedPipe(hPipe, NULL, 0, NULL, NULL, &dwLeft) || size + dwLeft > PROTOCOL_MAX_MESSAGE_SIZE)
+			break;
+
+		dwLeft = std::max<DWORD>(dwLeft, BUFSIZE);
+
+		serializerOut.commitBuffer(size);
+		szData = serializerOut.extendBuffer(dwLeft);
+
+		dwReaded = 0;
+		bSuccess = ReadFile(hPipe, szData, dwLeft, &dwReaded, NULL);
+		size += dwReaded;
+	}
+
+	if (!bSuccess)
+	{
+		dwError = GetLastError();
+		return false;
+	}
+
+	serializerOut.commitBuffer(size);
+	return true;
+}
@@ -1,16 +1,60 @@
 #pragma once
+#include "Windows.h"
+#include "Transport.h"
 
-#define BUFSIZE	 4096
+#include <Shared/Protocol.h>
+
+#include <vector>
+#include <mutex>
+
+#define BUFSIZE	 PROTOCOL_CHUNK_SIZE
 #define TIME_OUT 100
+#define MAX_IDLE_CONNECTIONS 4
 
 class Serializer;
 
+// Sends one request to the server and receives its reply. Connections are kept open
+// and reused by later requests, a new one is only opened if none is idle or one broke.
 class PipeClient
 {
 public:
 	PipeClient(Serializer& serializerIn, Serializer& serializerOut);
 
 	bool success() const;
+
+	// Sends a one-way request, returns as soon as it has been written
+	static bool post(Serializer& serializerIn);
+
+	// Closes all idle connections, e.g. when the server has been injected again
+	static void closeConnections();
+
+	// Opens a new connection in message mode, INVALID_HANDLE_VALUE if the server isn't running
+	static HANDLE connect(DWORD dwFlagsAndAttributes);
+
 private:
 	bool m_bSuccess;
-};
\ No newline at end of file
+
+	static HANDLE acquireConnection(bool& bReused);
+	static void releaseConnection(HANDLE hPipe);
+	static bool send(Serializer& serializerIn, Serializer *serializerOut);
+	static bool write(HANDLE hPipe, Serializer& serializerIn, DWORD& dwError);
+	static bool transact(HANDLE hPipe, Serializer& serializerIn, Serializer& serializerOut, DWORD& dwError);
+
+	static std::vector<HANDLE> _idle;
+	static std::mutex _mtx;
+};
+
+// The default transport, over the pooled pipe connections of PipeClient
+class PipeTransport : public Transport
+{
+public:
+	bool transact(Serializer& serializerIn, Serializer& serializerOut) override
+	{
+		return PipeClient(serializerIn, serializerOut).success();
+	}
+
+	bool post(Serializer& serializerIn) override
+	{
+		return PipeClient::post(serializerIn);
+	}
+};
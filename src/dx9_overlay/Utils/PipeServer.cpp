@@ -1,176 +1,233 @@
 #include "PipeServer.h"
-#include "Serializer.h"
 
 #include <Shared/Config.h>
 
 #include <boost/thread.hpp>
 
-#define CONNECTING_STATE	0 
-#define READING_STATE		1 
-#define WRITING_STATE		2 
+#define CONNECTING_STATE	0
+#define READING_STATE		1
+#define WRITING_STATE		2
 
-BOOL PipeServer::connectToNewClient(HANDLE hPipe, LPOVERLAPPED lpo)
+PipeServer::PipeServer(MessageCallback func) : m_hPort(NULL), m_listening(0), m_cbCallback(func)
 {
-	BOOL fConnected, fPendingIO = FALSE;
+	memset(m_szPipe, 0, sizeof(m_szPipe));
 
-	fConnected = ConnectNamedPipe(hPipe, lpo);
+	sprintf_s(m_szPipe, "\\\\.\\pipe\\%s", g_strPipeName);
 
-	if (fConnected)
-		return 0;
+	m_hPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, PIPE_THREADS);
+	if (m_hPort == NULL)
+		return;
 
-	switch (GetLastError())
+	for (int i = 0; i < PIPE_LISTENERS; i++)
 	{
-	case ERROR_IO_PENDING:
-		fPendingIO = TRUE;
-		break;
+		Connection *connection = createInstance();
+		if (connection)
+			listen(connection);
+	}
 
-	case ERROR_PIPE_CONNECTED:
-		if (SetEvent(lpo->hEvent))
-			break;
-	default:
+	for (int i = 0; i < PIPE_THREADS; i++)
+		m_threads.push_back(new boost::thread(boost::bind(&PipeServer::thread, this)));
+}
+
+PipeServer::~PipeServer(void)
+{
+	if (m_hPort == NULL)
+		return;
+
+	// Every thread passes the wake-up on to the next one before it exits
+	PostQueuedCompletionStatus(m_hPort, 0, 0, NULL);
+
+	for (size_t i = 0; i < m_threads.size(); i++)
 	{
-		return 0;
-	}
+		if (m_threads[i]->joinable())
+			m_threads[i]->join();
+
+		delete m_threads[i];
 	}
 
-	return fPendingIO;
+	for (size_t i = 0; i < m_connections.size(); i++)
+		CloseHandle(m_connections[i]->hPipe);
+
+	m_connections.clear();
+	CloseHandle(m_hPort);
 }
 
-void PipeServer::disconnectAndReconnect(DWORD dwIdx)
+void PipeServer::thread()
 {
-	DisconnectNamedPipe(m_Pipes[dwIdx].m_hPipe);
-	m_Pipes[dwIdx].m_fPendingIO = connectToNewClient(m_Pipes[dwIdx].m_hPipe, &m_Pipes[dwIdx].m_Overlapped);
-	m_Pipes[dwIdx].m_dwState = m_Pipes[dwIdx].m_fPendingIO ? CONNECTING_STATE : READING_STATE;
+	OVERLAPPED_ENTRY entries[PIPE_BATCH];
+
+	while (true)
+	{
+		// Takes every completion which is ready at once, not only one per wake-up
+		ULONG ulCount = 0;
+		if (!GetQueuedCompletionStatusEx(m_hPort, entries, PIPE_BATCH, &ulCount, INFINITE, FALSE))
+			return;
+
+		for (ULONG i = 0; i < ulCount; i++)
+		{
+			if (entries[i].lpOverlapped == NULL)
+			{
+				PostQueuedCompletionStatus(m_hPort, 0, 0, NULL);
+				return;
+			}
+
+			Connection *connection = CONTAINING_RECORD(entries[i].lpOverlapped, Connection, overlapped);
 
+			DWORD dwBytes = 0;
+			DWORD dwError = ERROR_SUCCESS;
+			if (!GetOverlappedResult(connection->hPipe, &connection->overlapped, &dwBytes, FALSE))
+				dwError = GetLastError();
+
+			complete(connection, dwError, dwBytes);
+		}
+	}
 }
-PipeServer::PipeServer(boost::function<void(Serializer&, Serializer&)> func) : m_cbCallback(func), m_thread(0)
+
+PipeServer::Connection *PipeServer::createInstance()
 {
-	memset(m_szPipe, 0, sizeof(m_szPipe));
-	memset(m_Pipes, 0, sizeof(m_Pipes));
+	HANDLE hPipe = CreateNamedPipeA(m_szPipe, PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED, PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT,
+		MAX_CLIENTS, BUFSIZE, BUFSIZE, PIPE_TIMEOUT, NULL);
 
-	sprintf_s(m_szPipe, "\\\\.\\pipe\\%s", g_strPipeName);
+	if (hPipe == INVALID_HANDLE_VALUE)
+		return nullptr;
 
-	for (int i = 0; i < MAX_CLIENTS; i++)
+	if (CreateIoCompletionPort(hPipe, m_hPort, 0, 0) == NULL)
 	{
-		m_hEvents[i] = CreateEvent(NULL, TRUE, TRUE, NULL);
-		m_Pipes[i].m_Overlapped.hEvent = m_hEvents[i];
-		m_Pipes[i].m_hPipe = CreateNamedPipeA(m_szPipe, PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED, PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT,
-			MAX_CLIENTS, BUFSIZE, BUFSIZE, PIPE_TIMEOUT, NULL);
-
-		m_Pipes[i].m_fPendingIO = connectToNewClient(m_Pipes[i].m_hPipe, &m_Pipes[i].m_Overlapped);
-		m_Pipes[i].m_dwState = m_Pipes[i].m_fPendingIO ? CONNECTING_STATE : READING_STATE;
+		CloseHandle(hPipe);
+		return nullptr;
 	}
 
-	m_thread = new boost::thread(boost::bind(&PipeServer::thread, this));
-}
+	std::unique_ptr<Connection> connection(new Connection);
+	memset(&connection->overlapped, 0, sizeof(OVERLAPPED));
+	connection->hPipe = hPipe;
+	connection->dwState = CONNECTING_STATE;
+	connection->dwToWrite = 0;
 
+	std::lock_guard<std::mutex> lock(m_mtx);
+	m_connections.push_back(std::move(connection));
 
-PipeServer::~PipeServer(void)
+	return m_connections.back().get();
+}
+
+void PipeServer::listen(Connection *connection)
 {
-	if (m_thread)
+	connection->dwState = CONNECTING_STATE;
+	m_listening++;
+
+	if (!ConnectNamedPipe(connection->hPipe, &connection->overlapped))
 	{
-		m_thread->interrupt();
-		if (m_thread->joinable())
-			m_thread->join();
-		delete m_thread;
-		m_thread = NULL;
+		switch (GetLastError())
+		{
+		case ERROR_IO_PENDING:
+			return;
+
+		// The client connected before ConnectNamedPipe was called, no completion is queued for it
+		case ERROR_PIPE_CONNECTED:
+			break;
+
+		default:
+			m_listening--;
+			return closeInstance(connection);
+		}
 	}
+
+	complete(connection, ERROR_SUCCESS, 0);
 }
 
-void PipeServer::thread()
+void PipeServer::disconnect(Connection *connection)
 {
-	BOOL bSuccess;
-	DWORD dwRet;
+	DisconnectNamedPipe(connection->hPipe);
+	connection->messages.reset();
 
-	while (true)
-	{
-		boost::this_thread::interruption_point();
+	// Instances beyond the spare listeners are closed again once their client has left
+	if (m_listening < PIPE_LISTENERS)
+		return listen(connection);
 
-		DWORD dwWait = WaitForMultipleObjects(MAX_CLIENTS, m_hEvents, FALSE, INFINITE);
+	closeInstance(connection);
+}
 
-		int idx = dwWait - WAIT_OBJECT_0;
-		if (idx < 0 || idx >(MAX_CLIENTS - 1))
-			continue;
+void PipeServer::closeInstance(Connection *connection)
+{
+	CloseHandle(connection->hPipe);
 
-		if (m_Pipes[idx].m_fPendingIO)
+	std::lock_guard<std::mutex> lock(m_mtx);
+	for (auto it = m_connections.begin(); it != m_connections.end(); it++)
+	{
+		if (it->get() == connection)
 		{
-			bSuccess = GetOverlappedResult(m_Pipes[idx].m_hPipe, &m_Pipes[idx].m_Overlapped, &dwRet, FALSE);
+			m_connections.erase(it);
+			break;
+		}
+	}
+}
 
-			switch (m_Pipes[idx].m_dwState)
-			{
-			case CONNECTING_STATE:
-				if (!bSuccess)
-					return;
-				m_Pipes[idx].m_dwState = READING_STATE;
-				break;
-			case READING_STATE:
-				if (!bSuccess || dwRet == 0)
-				{
-					disconnectAndReconnect(idx);
-					continue;
-				}
-				m_Pipes[idx].m_dwRead = dwRet;
-				m_Pipes[idx].m_dwState = WRITING_STATE;
-				break;
-			case WRITING_STATE:
-				if (!bSuccess || dwRet != m_Pipes[idx].m_dwToWrite)
-				{
-					disconnectAndReconnect(idx);
-					continue;
-				}
-				m_Pipes[idx].m_dwState = READING_STATE;
-				break;
-			default:
-				return;
-			}
+void PipeServer::complete(Connection *connection, DWORD dwError, DWORD dwBytes)
+{
+	switch (connection->dwState)
+	{
+	case CONNECTING_STATE:
+		m_listening--;
+		if (dwError != ERROR_SUCCESS)
+			return disconnect(connection);
+
+		// Keep some instances waiting, so the next client doesn't have to retry
+		if (m_listening < PIPE_LISTENERS)
+		{
+			Connection *listener = createInstance();
+			if (listener)
+				listen(listener);
 		}
 
-		switch (m_Pipes[idx].m_dwState)
+		return readRequest(connection);
+
+	case READING_STATE:
+		// The message is larger than the buffer, the next read continues it
+		if (dwError == ERROR_MORE_DATA)
 		{
+			DWORD dwLeft = 0;
+			if (!PeekNamedPipe(connection->hPipe, NULL, 0, NULL, NULL, &dwLeft))
+				dwLeft = 0;
 
-		case READING_STATE:
-			bSuccess = ReadFile(m_Pipes[idx].m_hPipe, m_Pipes[idx].m_szRequest, BUFSIZE, &m_Pipes[idx].m_dwRead, &m_Pipes[idx].m_Overlapped);
+			if (!connection->messages.continueRequest(dwBytes, dwLeft))
+				return disconnect(connection);
 
-			if (bSuccess && m_Pipes[idx].m_dwRead != 0)
-			{
-				m_Pipes[idx].m_fPendingIO = FALSE;
-				m_Pipes[idx].m_dwState = WRITING_STATE;
-				continue;
-			}
-			if (!bSuccess && (GetLastError() == ERROR_IO_PENDING))
-			{
-				m_Pipes[idx].m_fPendingIO = TRUE;
-				continue;
-			}
-			disconnectAndReconnect(idx);
-			break;
-		case WRITING_STATE:
-			Serializer serializerIn(m_Pipes[idx].m_szRequest, m_Pipes[idx].m_dwRead);
-			Serializer serializerOut;
+			return readRequest(connection);
+		}
 
-			m_cbCallback(serializerIn, serializerOut);
+		if (dwError != ERROR_SUCCESS || dwBytes == 0)
+			return disconnect(connection);
 
-			memset(m_Pipes[idx].m_szReply, 0, BUFSIZE);
-			memset(m_Pipes[idx].m_szRequest, 0, BUFSIZE);
-			memcpy(m_Pipes[idx].m_szReply, serializerOut.data(), serializerOut.numberOfBytesUsed());
+		connection->messages.completeRequest(dwBytes);
+		return handleRequest(connection);
 
-			m_Pipes[idx].m_dwToWrite = serializerOut.numberOfBytesUsed();
+	case WRITING_STATE:
+		if (dwError != ERROR_SUCCESS || dwBytes != connection->dwToWrite)
+			return disconnect(connection);
 
-			bSuccess = WriteFile(m_Pipes[idx].m_hPipe, m_Pipes[idx].m_szReply, m_Pipes[idx].m_dwToWrite, &dwRet, &m_Pipes[idx].m_Overlapped);
-			if (bSuccess && dwRet == m_Pipes[idx].m_dwToWrite)
-			{
-				m_Pipes[idx].m_fPendingIO = FALSE;
-				m_Pipes[idx].m_dwState = READING_STATE;
-				continue;
-			}
-			if (!bSuccess && GetLastError() == ERROR_IO_PENDING)
-			{
-				m_Pipes[idx].m_fPendingIO = true;
-				continue;
-			}
-			disconnectAndReconnect(idx);
-			break;
-		}
+		return readRequest(connection);
 	}
 }
 
+void PipeServer::readRequest(Connection *connection)
+{
+	connection->dwState = READING_STATE;
+
+	BOOL bSuccess = ReadFile(connection->hPipe, connection->messages.readBuffer(), connection->messages.readSpace(), NULL, &connection->overlapped);
+
+	// Reads which finish at once are queued to the completion port as well
+	if (!bSuccess && GetLastError() != ERROR_IO_PENDING && GetLastError() != ERROR_MORE_DATA)
+		disconnect(connection);
+}
+
+void PipeServer::handleRequest(Connection *connection)
+{
+	// The client doesn't wait for a reply, continue with the next request
+	if (!connection->messages.handleRequest(m_cbCallback))
+		return readRequest(connection);
+
+	connection->dwState = WRITING_STATE;
+	connection->dwToWrite = connection->messages.replySize();
+
+	if (!WriteFile(connection->hPipe, connection->messages.reply(), connection->dwToWrite, NULL, &connection->overlapped) && GetLastError() != ERROR_IO_PENDING)
+		disconnect(connection);
+}
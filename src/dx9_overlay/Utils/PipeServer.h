@@ -1,45 +1,68 @@
 #pragma once
 #include "Windows.h"
 
-#include <boost/function.hpp>
+#include "ServerConnection.h"
+#include "Transport.h"
+
+#include <Shared/Protocol.h>
+
 #include <boost/bind.hpp>
 
-#define MAX_CLIENTS		16
-#define BUFSIZE			4096
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define MAX_CLIENTS		PIPE_UNLIMITED_INSTANCES
+#define PIPE_LISTENERS	4
+#define PIPE_THREADS	4
+#define PIPE_BATCH		64
+#define BUFSIZE			PROTOCOL_CHUNK_SIZE
 #define PIPE_TIMEOUT	5000
 
 namespace boost { class thread; }
-class Serializer;
 
+// Serves the message pipe through an I/O completion port. Every pipe instance has at most one
+// read or write in flight, a fixed set of threads handles whichever completes. A few instances
+// always wait for new clients, more are created as clients connect and closed as they leave.
 class PipeServer
 {
-	typedef struct
+	struct Connection
 	{
-		OVERLAPPED	m_Overlapped;
-		HANDLE		m_hPipe;
-		char		m_szRequest[BUFSIZE],
-					m_szReply[BUFSIZE];
-		DWORD		m_dwRead,
-					m_dwToWrite,
-					m_dwState;
-		BOOL		m_fPendingIO;
-	} PIPEINSTANCE, *LPPIPEINSTANCE;
+		OVERLAPPED	overlapped;
+		HANDLE		hPipe;
+		DWORD		dwState;
+		DWORD		dwToWrite;
+
+		// Assembles the requests and holds the reply which is being written
+		ServerConnection	messages;
+	};
 
 public:
-	PipeServer(boost::function<void(Serializer&, Serializer&)> func);
+	PipeServer(MessageCallback func);
 	~PipeServer();
 
 private:
 	void thread();
-	BOOL connectToNewClient(HANDLE hPipe, LPOVERLAPPED lpo);
-	void disconnectAndReconnect(DWORD dwIdx);
 
-	PIPEINSTANCE m_Pipes[MAX_CLIENTS];
-	HANDLE m_hEvents[MAX_CLIENTS];
+	Connection *createInstance();
+	void listen(Connection *connection);
+	void disconnect(Connection *connection);
+	void closeInstance(Connection *connection);
+	void complete(Connection *connection, DWORD dwError, DWORD dwBytes);
 
+	void readRequest(Connection *connection);
+	void handleRequest(Connection *connection);
+
+	HANDLE m_hPort;
 	char m_szPipe[MAX_PATH];
 
-	boost::thread *m_thread;
-	boost::function<void(Serializer&, Serializer&)> m_cbCallback;
-};
+	std::vector<std::unique_ptr<Connection> > m_connections;
+	std::mutex m_mtx;
 
+	// Instances which are waiting for a client
+	std::atomic<int> m_listening;
+
+	std::vector<boost::thread *> m_threads;
+	MessageCallback m_cbCallback;
+};
@@ -0,0 +1,208 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+// Single-producer/single-consumer queue of variable sized records inside a caller-provided
+// memory block, e.g. a shared memory mapping. Both sides construct a RingBuffer on the same
+// block, only the creator calls format(). Nothing here depends on the platform: waking up an
+// idle consumer is left to the caller, see beginWait() and wakeupNeeded().
+//
+// Records are stored as a 4 byte length followed by the payload, padded to 4 bytes.
+// A record never wraps around, the producer skips the rest of the block instead.
+//
+// The other side may be another process, so the consumer checks every length it reads.
+// A malformed record can't be skipped on its own, everything up to the head is dropped then.
+class RingBuffer
+{
+	struct Header
+	{
+		std::atomic<uint32_t> head;				// written by the producer
+		std::atomic<uint32_t> tail;				// written by the consumer
+		std::atomic<uint32_t> consumerWaiting;
+		uint32_t capacity;
+	};
+
+	enum { HeaderSize = 64, WrapMarker = 0xFFFFFFFF };
+
+public:
+	// Size of the memory block for a ring with 'capacity' bytes of records (a power of two)
+	static size_t blockSize(uint32_t capacity)
+	{
+		return HeaderSize + capacity;
+	}
+
+	static void format(void *block, uint32_t capacity)
+	{
+		Header *header = new (block) Header;
+		header->head.store(0);
+		header->tail.store(0);
+		header->consumerWaiting.store(0);
+		header->capacity = capacity;
+	}
+
+	explicit RingBuffer(void *block)
+		: _header(static_cast<Header *>(block)), _data(static_cast<char *>(block) + HeaderSize),
+		_capacity(_header->capacity), _peekedSize(0)
+	{
+	}
+
+	uint32_t capacity() const
+	{
+		return _capacity;
+	}
+
+	// Largest payload which fits into the ring at all
+	uint32_t maxRecordSize() const
+	{
+		return capacity() / 2 - sizeof(uint32_t);
+	}
+
+	// Producer: appends a record, fails if there isn't enough free space right now
+	bool push(const char *data, uint32_t size)
+	{
+		if (size > maxRecordSize())
+			return false;
+
+		uint32_t capacity = _capacity;
+		uint32_t head = _header->head.load(std::memory_order_relaxed);
+		uint32_t tail = _header->tail.load(std::memory_order_acquire);
+
+		uint32_t needed = recordSize(size);
+		uint32_t offset = head & (capacity - 1);
+		uint32_t toEnd = capacity - offset;
+		uint32_t skipped = (toEnd < needed) ? toEnd : 0;
+
+		if (capacity - (head - tail) < skipped + needed)
+			return false;
+
+		if (skipped)
+		{
+			writeLength(offset, WrapMarker);
+			head += skipped;
+			offset = 0;
+		}
+
+		writeLength(offset, size);
+		memcpy(_data + offset + sizeof(uint32_t), data, size);
+
+		// Sequentially consistent like consumerWaiting, otherwise wakeupNeeded() could read the flag
+		// before the consumer sees the record, and both sides would miss each other
+		_header->head.store(head + needed, std::memory_order_seq_cst);
+		return true;
+	}
+
+	// Consumer: exposes the oldest record without copying it, pop() releases it
+	bool peek(const char *&data, uint32_t& size)
+	{
+		uint32_t capacity = _capacity;
+		uint32_t tail = _header->tail.load(std::memory_order_relaxed);
+		uint32_t head = _header->head.load(std::memory_order_acquire);
+
+		uint32_t available = head - tail;
+		if (available == 0)
+			return false;
+
+		if (available > capacity)
+			return discard(head);
+
+		uint32_t offset = tail & (capacity - 1);
+		uint32_t length = readLength(offset);
+
+		// push() writes the record behind a wrap marker together with it
+		if (length == WrapMarker)
+		{
+			uint32_t skipped = capacity - offset;
+			if (skipped >= available)
+				return discard(head);
+
+			tail += skipped;
+			available -= skipped;
+			_header->tail.store(tail, std::memory_order_release);
+
+			offset = 0;
+			length = readLength(offset);
+		}
+
+		if (length > maxRecordSize() || recordSize(length) > available || offset + recordSize(length) > capacity)
+			return discard(head);
+
+		data = _data + offset + sizeof(uint32_t);
+		size = _peekedSize = length;
+		return true;
+	}
+
+	void pop()
+	{
+		uint32_t tail = _header->tail.load(std::memory_order_relaxed);
+		_header->tail.store(tail + recordSize(_peekedSize), std::memory_order_release);
+		_peekedSize = 0;
+	}
+
+	// Sequentially consistent, beginWait() relies on it to see a record pushed before wakeupNeeded()
+	bool empty() const
+	{
+		return _header->tail.load(std::memory_order_seq_cst) == _header->head.load(std::memory_order_seq_cst);
+	}
+
+	// Consumer: announces that it is about to sleep. Returns false if a record arrived
+	// in the meantime, otherwise the caller waits for its signal and calls endWait().
+	bool beginWait()
+	{
+		_header->consumerWaiting.store(1, std::memory_order_seq_cst);
+
+		if (!empty())
+		{
+			endWait();
+			return false;
+		}
+
+		return true;
+	}
+
+	void endWait()
+	{
+		_header->consumerWaiting.store(0, std::memory_order_seq_cst);
+	}
+
+	// Producer: called after push(), true if the consumer sleeps and has to be signaled
+	bool wakeupNeeded()
+	{
+		return _header->consumerWaiting.exchange(0, std::memory_order_seq_cst) != 0;
+	}
+
+private:
+	static uint32_t recordSize(uint32_t size)
+	{
+		return (sizeof(uint32_t) + size + 3) & ~3u;
+	}
+
+	uint32_t readLength(uint32_t offset) const
+	{
+		uint32_t length;
+		memcpy(&length, _data + offset, sizeof(length));
+		return length;
+	}
+
+	void writeLength(uint32_t offset, uint32_t length)
+	{
+		memcpy(_data + offset, &length, sizeof(length));
+	}
+
+	// Consumer: drops every record up to 'head', peek() reports an empty ring
+	bool discard(uint32_t head)
+	{
+		_header->tail.store(head, std::memory_order_release);
+		_peekedSize = 0;
+		return false;
+	}
+
+	Header *_header;
+	char *_data;
+
+	// Read once, the producer can't change the size of the block
+	uint32_t _capacity;
+	uint32_t _peekedSize;
+};
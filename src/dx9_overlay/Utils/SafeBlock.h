@@ -3,7 +3,7 @@
 #include <functional>
 #include <memory>
 
-template<class Executer, typename ...T, typename Ret = std::result_of<Executer(T...)>::type>
+template<class Executer, typename ...T, typename Ret = typename std::result_of<Executer(T...)>::type>
 Ret safeExecute(Executer executer, T&&... args)
 {
 	try 
@@ -1,36 +1,237 @@
 #include "Serializer.h"
 
-Serializer::Serializer()
+#include <algorithm>
+#include <cstring>
+
+Serializer::Serializer() : _data(nullptr), _size(0), _capacity(0), _readPos(0)
 {
-	_oa = safeMakeShared<oarchive>(_ss);
 }
 
-Serializer::Serializer(const char * const _data, const unsigned int len) : _ss(std::string(_data, len))
+Serializer::Serializer(const char * const _data, const unsigned int len)
+	: _data(const_cast<char *>(_data)), _size(len), _capacity(len), _readPos(0)
 {
-	_ia = safeMakeShared<iarchive>(_ss);
 }
 
 Serializer::~Serializer()
 {
-	safeExecute([&](){
-		_oa.reset();
-		_ia.reset();
-	});
 }
 
 const char * Serializer::data()
 {
-	_ss_str = _ss.str();
-	return _ss_str.c_str();
+	return _data;
 }
 
 void Serializer::setData(const char *szData, const size_t size)
 {
-	_ss = std::stringstream(std::string(szData, size));
-	_ia = safeMakeShared<iarchive>(_ss);
+	clear();
+	writeBytes(szData, size);
 }
 
 int Serializer::numberOfBytesUsed() const
 {
-	return _ss.str().length();
+	return (int) _size;
+}
+
+void Serializer::clear()
+{
+	_size = 0;
+	_readPos = 0;
+	_data = _storage.empty() ? nullptr : &_storage[0];
+	_capacity = _storage.size();
+}
+
+void Serializer::attachOutput(char *buffer, size_t capacity)
+{
+	_data = buffer;
+	_capacity = capacity;
+	_size = 0;
+	_readPos = 0;
+}
+
+char * Serializer::prepareBuffer(size_t capacity)
+{
+	clear();
+	reserve(capacity);
+	return _data;
+}
+
+void Serializer::commitBuffer(size_t size)
+{
+	_size = std::min(size, _capacity);
+	_readPos = 0;
+}
+
+char * Serializer::extendBuffer(size_t additional)
+{
+	reserve(_size + additional);
+	return _data + _size;
+}
+
+bool Serializer::ownsData() const
+{
+	return !_storage.empty() && _data == &_storage[0];
+}
+
+void Serializer::reserve(size_t size)
+{
+	if (size <= _capacity)
+		return;
+
+	size_t capacity = std::max<size_t>(std::max(size, _capacity * 2), 64);
+
+	if (ownsData())
+	{
+		_storage.resize(capacity);
+	}
+	else
+	{
+		// Leave the caller-owned buffer and continue in our own storage
+		if (_storage.size() < capacity)
+			_storage.resize(capacity);
+
+		if (_size > 0)
+			memmove(&_storage[0], _data, _size);
+	}
+
+	_data = &_storage[0];
+	_capacity = _storage.size();
+}
+
+void Serializer::writeByte(char byte)
+{
+	if (_size == _capacity)
+		reserve(_size + 1);
+
+	_data[_size++] = byte;
+}
+
+void Serializer::writeBytes(const char *bytes, size_t size)
+{
+	if (size == 0)
+		return;
+
+	reserve(_size + size);
+	memcpy(_data + _size, bytes, size);
+	_size += size;
+}
+
+void Serializer::writeFixed(uint64_t value, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+		writeByte((char) ((value >> (i * 8)) & 0xFF));
+}
+
+void Serializer::writeVarint(uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		writeByte((char) ((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+
+	writeByte((char) value);
+}
+
+bool Serializer::readFixed(uint64_t& value, size_t size)
+{
+	value = 0;
+
+	if (_size - _readPos < size)
+	{
+		_readPos = _size;
+		return false;
+	}
+
+	for (size_t i = 0; i < size; i++)
+		value |= uint64_t((unsigned char) _data[_readPos++]) << (i * 8);
+
+	return true;
+}
+
+bool Serializer::readVarint(uint64_t& value)
+{
+	value = 0;
+
+	for (int shift = 0; shift < 64 && _readPos < _size; shift += 7)
+	{
+		unsigned char byte = (unsigned char) _data[_readPos++];
+		value |= uint64_t(byte & 0x7F) << shift;
+
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+
+	value = 0;
+	return false;
+}
+
+size_t Serializer::readLength()
+{
+	uint64_t length = 0;
+	readVarint(length);
+
+	// Every code unit takes at least one byte
+	if (length > _size - _readPos)
+		length = _size - _readPos;
+
+	return (size_t) length;
+}
+
+void Serializer::write(bool b)
+{
+	writeByte(b ? 1 : 0);
+}
+
+void Serializer::write(const std::string& str)
+{
+	writeVarint(str.length());
+	writeBytes(str.data(), str.length());
+}
+
+void Serializer::write(const std::wstring& str)
+{
+	// Code units are stored as varints, so that the encoding does not depend on sizeof(wchar_t)
+	writeVarint(str.length());
+	for (auto c : str)
+		writeVarint((uint64_t) c);
+}
+
+void Serializer::write(const boost::string_ref& str)
+{
+	writeVarint(str.length());
+	writeBytes(str.data(), str.length());
+}
+
+void Serializer::read(bool& b)
+{
+	uint64_t value = 0;
+	readFixed(value, 1);
+	b = value != 0;
+}
+
+void Serializer::read(std::string& str)
+{
+	size_t length = readLength();
+
+	str.assign(_data + _readPos, length);
+	_readPos += length;
+}
+
+void Serializer::read(std::wstring& str)
+{
+	str.resize(readLength());
+	for (size_t i = 0; i < str.length(); i++)
+	{
+		uint64_t c = 0;
+		readVarint(c);
+		str[i] = (wchar_t) c;
+	}
+}
+
+void Serializer::read(boost::string_ref& str)
+{
+	size_t length = readLength();
+
+	str = boost::string_ref(_data + _readPos, length);
+	_readPos += length;
 }
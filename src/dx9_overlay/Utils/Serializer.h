@@ -1,26 +1,32 @@
 #pragma once
-#include "SafeBlock.h"
+#include <boost/utility/string_ref.hpp>
 
-#include <boost/archive/text_oarchive.hpp>
-#include <boost/archive/text_iarchive.hpp>
-
-#include <sstream>
 #include <string>
-#include <memory>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
 
 #define SERIALIZATION_READ(S, T, V) T V; S >> V;
 
+// Compact little-endian binary encoding used for every PipeMessages payload.
+//
+//	bool, char			1 byte
+//	enums				fixed width of the underlying type (PipeMessages: 2 bytes)
+//	signed integers		zigzag varint (coordinates and sizes mostly fit into 1-2 bytes)
+//	unsigned integers	fixed width (colors are ARGB and rarely shrink as a varint)
+//	strings				varint length prefix followed by the code units
+//
+// Reading past the end of the payload yields zero values instead of throwing.
+//
+// A Serializer either owns a growable buffer, which keeps its capacity across clear(),
+// or works in place on a caller-owned buffer:
+//	- Serializer(data, len) reads directly from the given bytes without copying them;
+//	  boost::string_ref values read from it point into that buffer.
+//	- attachOutput(buffer, capacity) writes directly into the given buffer. Only if the
+//	  capacity is exceeded, the payload is moved into the Serializer's own storage.
 class Serializer
 {
-	typedef boost::archive::text_iarchive iarchive;
-	typedef boost::archive::text_oarchive oarchive;
-
-	std::shared_ptr<oarchive> _oa;
-	std::shared_ptr<iarchive> _ia;
-
-	std::stringstream _ss;
-	std::string _ss_str;
-
 public:
 	Serializer();
 	Serializer(const char * const _data, const unsigned int len);
@@ -32,33 +38,111 @@ public:
 
 	int numberOfBytesUsed() const;
 
+	void clear();
+	void attachOutput(char *buffer, size_t capacity);
+
+	// Exposes at least 'capacity' writable bytes (e.g. for ReadFile), commitBuffer() makes them readable
+	char *prepareBuffer(size_t capacity);
+	void commitBuffer(size_t size);
+	// Like prepareBuffer(), but keeps the committed bytes and returns the space behind them
+	char *extendBuffer(size_t additional);
+
 	template<class T>
 	Serializer& operator<<(const T& t)
 	{
-		write<T>(t);
+		write(t);
 		return *this;
 	}
 	template<class T>
 	Serializer& operator>>(T& t)
 	{
-		read<T>(t);
+		read(t);
 		return *this;
 	}
 
 private:
+	Serializer(const Serializer&);
+	Serializer& operator=(const Serializer&);
+
+	char *_data;
+	size_t _size, _capacity, _readPos;
+	std::vector<char> _storage;
+
+	bool ownsData() const;
+	void reserve(size_t size);
+
+	void writeByte(char byte);
+	void writeBytes(const char *bytes, size_t size);
+	void writeFixed(uint64_t value, size_t size);
+	void writeVarint(uint64_t value);
+	bool readFixed(uint64_t& value, size_t size);
+	bool readVarint(uint64_t& value);
+	size_t readLength();
+
+	void write(bool b);
+	void write(const std::string& str);
+	void write(const std::wstring& str);
+	void write(const boost::string_ref& str);
+
+	void read(bool& b);
+	void read(std::string& str);
+	void read(std::wstring& str);
+	void read(boost::string_ref& str);
+
+	template<class T>
+	typename std::enable_if<std::is_enum<T>::value>::type write(const T& t)
+	{
+		writeFixed((uint64_t) t, sizeof(T));
+	}
+
+	template<class T>
+	typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type write(const T& t)
+	{
+		int64_t value = t;
+		writeVarint((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+	}
+
+	template<class T>
+	typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type write(const T& t)
+	{
+		writeFixed(t, sizeof(T));
+	}
+
+	template<class A, class B>
+	void write(const std::pair<A, B>& p)
+	{
+		write(p.first);
+		write(p.second);
+	}
+
+	template<class A, class B>
+	void read(std::pair<A, B>& p)
+	{
+		read(p.first);
+		read(p.second);
+	}
+
+	template<class T>
+	typename std::enable_if<std::is_enum<T>::value>::type read(T& t)
+	{
+		uint64_t value = 0;
+		readFixed(value, sizeof(T));
+		t = (T) value;
+	}
+
 	template<class T>
-	void write(const T& t)
+	typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type read(T& t)
 	{
-		safeExecute([&](){
-			*_oa & t;
-		});
+		uint64_t value = 0;
+		readVarint(value);
+		t = (T) (int64_t(value >> 1) ^ -int64_t(value & 1));
 	}
 
 	template<class T>
-	void read(T& t)
+	typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type read(T& t)
 	{
-		safeExecute([&](){
-			*_ia & t;
-		});
+		uint64_t value = 0;
+		readFixed(value, sizeof(T));
+		t = (T) value;
 	}
 };
@@ -0,0 +1,48 @@
+#include "SerializerPool.h"
+
+std::vector<SerializerPool::Entry *> SerializerPool::_free;
+std::mutex SerializerPool::_mtx;
+
+SerializerPool::Lease::Lease() : _entry(SerializerPool::acquire())
+{
+}
+
+SerializerPool::Lease::~Lease()
+{
+	SerializerPool::release(_entry);
+}
+
+Serializer& SerializerPool::Lease::in()
+{
+	return _entry->in;
+}
+
+Serializer& SerializerPool::Lease::out()
+{
+	return _entry->out;
+}
+
+SerializerPool::Entry *SerializerPool::acquire()
+{
+	{
+		std::lock_guard<std::mutex> l(_mtx);
+
+		if (!_free.empty())
+		{
+			Entry *entry = _free.back();
+			_free.pop_back();
+			return entry;
+		}
+	}
+
+	return new Entry;
+}
+
+void SerializerPool::release(Entry *entry)
+{
+	entry->in.clear();
+	entry->out.clear();
+
+	std::lock_guard<std::mutex> l(_mtx);
+	_free.push_back(entry);
+}
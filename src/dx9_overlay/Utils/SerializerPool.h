@@ -0,0 +1,43 @@
+#pragma once
+#include "Serializer.h"
+
+#include <vector>
+#include <mutex>
+
+#define POOLED_SERIALIZERS(IN, OUT)					\
+	SerializerPool::Lease _serializerLease;			\
+	Serializer& IN = _serializerLease.in();			\
+	Serializer& OUT = _serializerLease.out();		\
+
+// Keeps request/reply Serializer pairs alive between calls, so their buffers are reused
+class SerializerPool
+{
+	struct Entry
+	{
+		Serializer in, out;
+	};
+
+public:
+	class Lease
+	{
+	public:
+		Lease();
+		~Lease();
+
+		Serializer& in();
+		Serializer& out();
+
+	private:
+		Lease(const Lease&);
+		Lease& operator=(const Lease&);
+
+		Entry *_entry;
+	};
+
+private:
+	static Entry *acquire();
+	static void release(Entry *entry);
+
+	static std::vector<Entry *> _free;
+	static std::mutex _mtx;
+};
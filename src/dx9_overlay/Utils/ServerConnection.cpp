@@ -0,0 +1,84 @@
+#include "ServerConnection.h"
+
+ServerConnection::ServerConnection() : m_read(0)
+{
+}
+
+char *ServerConnection::readBuffer()
+{
+	if (m_largeRequest.empty())
+		return m_szRequest;
+
+	return &m_largeRequest[m_read];
+}
+
+uint32_t ServerConnection::readSpace() const
+{
+	if (m_largeRequest.empty())
+		return sizeof(m_szRequest);
+
+	return uint32_t(m_largeRequest.size() - m_read);
+}
+
+bool ServerConnection::continueRequest(uint32_t bytes, uint32_t left)
+{
+	if (m_largeRequest.empty())
+	{
+		m_largeRequest.assign(m_szRequest, m_szRequest + bytes);
+		m_read = bytes;
+	}
+	else
+		m_read += bytes;
+
+	if (left == 0)
+		left = sizeof(m_szRequest);
+
+	if (m_read + left > PROTOCOL_MAX_MESSAGE_SIZE)
+	{
+		reset();
+		return false;
+	}
+
+	m_largeRequest.resize(m_read + left);
+	return true;
+}
+
+void ServerConnection::completeRequest(uint32_t bytes)
+{
+	if (m_largeRequest.empty())
+		m_read = bytes;
+	else
+		m_read += bytes;
+}
+
+bool ServerConnection::handleRequest(const MessageCallback& callback)
+{
+	// Decode in place from the request buffer and encode the reply straight into the reply buffer
+	const char *data = m_largeRequest.empty() ? m_szRequest : &m_largeRequest[0];
+
+	Serializer serializerIn(data, m_read);
+	m_reply.attachOutput(m_szReply, sizeof(m_szReply));
+
+	callback(serializerIn, m_reply);
+
+	bool bOneWay = isOneWayRequest(data, m_read);
+	reset();
+
+	return !bOneWay;
+}
+
+const char *ServerConnection::reply()
+{
+	return m_reply.data();
+}
+
+uint32_t ServerConnection::replySize() const
+{
+	return (uint32_t) m_reply.numberOfBytesUsed();
+}
+
+void ServerConnection::reset()
+{
+	std::vector<char>().swap(m_largeRequest);
+	m_read = 0;
+}
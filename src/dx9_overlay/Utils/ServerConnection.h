@@ -0,0 +1,48 @@
+#pragma once
+#include "Serializer.h"
+#include "Transport.h"
+
+#include <Shared/Protocol.h>
+
+#include <cstdint>
+#include <vector>
+
+// The part of a server connection which doesn't depend on the transport. A request arrives in
+// one or more reads: the first one goes into a fixed buffer, a message which continues beyond it
+// is assembled in its own storage. The reply is encoded into a fixed buffer as well, larger
+// replies move into the Serializer's storage. Either stays alive until it has been written.
+class ServerConnection
+{
+public:
+	ServerConnection();
+
+	// Where the next read goes and how many bytes fit there
+	char *readBuffer();
+	uint32_t readSpace() const;
+
+	// A read of 'bytes' ended in the middle of a message, 'left' more bytes follow (0 if unknown).
+	// Fails and drops the message if it exceeds PROTOCOL_MAX_MESSAGE_SIZE.
+	bool continueRequest(uint32_t bytes, uint32_t left);
+	// A read of 'bytes' completed the message
+	void completeRequest(uint32_t bytes);
+
+	// Hands the message to the callback. Returns false for one-way requests, they aren't answered.
+	bool handleRequest(const MessageCallback& callback);
+
+	const char *reply();
+	uint32_t replySize() const;
+
+	// Drops a partial request, e.g. when the client has left
+	void reset();
+
+private:
+	ServerConnection(const ServerConnection&);
+	ServerConnection& operator=(const ServerConnection&);
+
+	char m_szRequest[PROTOCOL_CHUNK_SIZE],
+		 m_szReply[PROTOCOL_CHUNK_SIZE];
+	uint32_t m_read;
+
+	std::vector<char> m_largeRequest;
+	Serializer m_reply;
+};
@@ -0,0 +1,219 @@
+#include "SharedMemoryChannel.h"
+
+#include <Shared/Config.h>
+#include <Shared/Protocol.h>
+
+SharedMemoryChannel::SharedMemoryChannel()
+	: m_hMapping(NULL), m_hRequestEvent(NULL), m_hReplyEvent(NULL), m_pView(nullptr)
+{
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+	close();
+}
+
+std::string SharedMemoryChannel::nameOf(int id)
+{
+	char szName[MAX_PATH + 1] = { 0 };
+	sprintf_s(szName, "Local\\%s_shm_%d", g_strPipeName, id);
+
+	return szName;
+}
+
+bool SharedMemoryChannel::create(const std::string& name)
+{
+	return map(true, name);
+}
+
+bool SharedMemoryChannel::open(const std::string& name)
+{
+	return map(false, name);
+}
+
+bool SharedMemoryChannel::map(bool bCreate, const std::string& name)
+{
+	close();
+
+	DWORD dwRingSize = (DWORD) RingBuffer::blockSize(SHARED_MEMORY_RING_SIZE);
+
+	if (bCreate)
+	{
+		m_hMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, dwRingSize * 2, name.c_str());
+		m_hRequestEvent = CreateEventA(NULL, FALSE, FALSE, (name + "_req").c_str());
+		m_hReplyEvent = CreateEventA(NULL, FALSE, FALSE, (name + "_rep").c_str());
+	}
+	else
+	{
+		m_hMapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+		m_hRequestEvent = OpenEventA(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, (name + "_req").c_str());
+		m_hReplyEvent = OpenEventA(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, (name + "_rep").c_str());
+	}
+
+	if (m_hMapping == NULL || m_hRequestEvent == NULL || m_hReplyEvent == NULL)
+	{
+		close();
+		return false;
+	}
+
+	m_pView = (char *) MapViewOfFile(m_hMapping, FILE_MAP_ALL_ACCESS, 0, 0, dwRingSize * 2);
+	if (m_pView == nullptr)
+	{
+		close();
+		return false;
+	}
+
+	if (bCreate)
+	{
+		RingBuffer::format(m_pView, SHARED_MEMORY_RING_SIZE);
+		RingBuffer::format(m_pView + dwRingSize, SHARED_MEMORY_RING_SIZE);
+	}
+
+	m_requests.reset(new RingBuffer(m_pView));
+	m_replies.reset(new RingBuffer(m_pView + dwRingSize));
+
+	// The offsets of the records are bounded by the capacity, it has to match the mapped view
+	if (m_requests->capacity() != SHARED_MEMORY_RING_SIZE || m_replies->capacity() != SHARED_MEMORY_RING_SIZE)
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void SharedMemoryChannel::close()
+{
+	m_requests.reset();
+	m_replies.reset();
+
+	if (m_pView)
+	{
+		UnmapViewOfFile(m_pView);
+		m_pView = nullptr;
+	}
+
+	HANDLE *handles[] = { &m_hMapping, &m_hRequestEvent, &m_hReplyEvent };
+	for (size_t i = 0; i < ARRAYSIZE(handles); i++)
+	{
+		if (*handles[i])
+		{
+			CloseHandle(*handles[i]);
+			*handles[i] = NULL;
+		}
+	}
+}
+
+bool SharedMemoryChannel::isOpen() const
+{
+	return m_pView != nullptr;
+}
+
+uint32_t SharedMemoryChannel::maxMessageSize() const
+{
+	return isOpen() ? m_requests->maxRecordSize() : 0;
+}
+
+bool SharedMemoryChannel::waitFor(RingBuffer& ring, HANDLE hEvent, DWORD dwTimeout)
+{
+	DWORD dwStart = GetTickCount();
+
+	// The event may still be set from a wake-up which wasn't needed anymore, so it is only a hint
+	while (ring.empty())
+	{
+		DWORD dwElapsed = GetTickCount() - dwStart;
+		if (dwElapsed >= dwTimeout)
+			return false;
+
+		if (ring.beginWait())
+		{
+			WaitForSingleObject(hEvent, dwTimeout - dwElapsed);
+			ring.endWait();
+		}
+	}
+
+	return true;
+}
+
+void SharedMemoryChannel::notify(RingBuffer& ring, HANDLE hEvent)
+{
+	if (ring.wakeupNeeded())
+		SetEvent(hEvent);
+}
+
+// Waits for the server to make room if the ring is full of queued one-way messages
+bool SharedMemoryChannel::pushRequest(Serializer& serializerIn)
+{
+	uint32_t size = (uint32_t) serializerIn.numberOfBytesUsed();
+	if (!isOpen() || size > m_requests->maxRecordSize())
+		return false;
+
+	DWORD dwStart = GetTickCount();
+	while (!m_requests->push(serializerIn.data(), size))
+	{
+		if (GetTickCount() - dwStart >= SHARED_MEMORY_TIMEOUT)
+		{
+			close();
+			return false;
+		}
+
+		Sleep(0);
+	}
+
+	notify(*m_requests, m_hRequestEvent);
+	return true;
+}
+
+bool SharedMemoryChannel::transact(Serializer& serializerIn, Serializer& serializerOut)
+{
+	if (!pushRequest(serializerIn))
+		return false;
+
+	// A late reply would be taken for the answer to the next request, so the channel is given up
+	const char *data = nullptr;
+	uint32_t size = 0;
+	if (!waitFor(*m_replies, m_hReplyEvent, SHARED_MEMORY_TIMEOUT) || !m_replies->peek(data, size))
+	{
+		close();
+		return false;
+	}
+
+	serializerOut.setData(data, size);
+	m_replies->pop();
+	return true;
+}
+
+bool SharedMemoryChannel::post(Serializer& serializerIn)
+{
+	return pushRequest(serializerIn);
+}
+
+bool SharedMemoryChannel::serve(const MessageCallback& callback, DWORD dwTimeout)
+{
+	if (!isOpen() || !waitFor(*m_requests, m_hRequestEvent, dwTimeout))
+		return false;
+
+	const char *data = nullptr;
+	uint32_t size = 0;
+	if (!m_requests->peek(data, size))
+		return false;
+
+	// The request is decoded in place from the ring and released once it has been handled
+	Serializer serializerIn(data, size);
+	m_reply.clear();
+
+	callback(serializerIn, m_reply);
+
+	bool bOneWay = isOneWayRequest(data, size);
+	m_requests->pop();
+
+	if (bOneWay)
+		return true;
+
+	// The client waits for each reply before it sends the next request, so the reply ring is empty
+	// here. Only a reply larger than the ring is dropped, the client gives up after its timeout.
+	if (m_replies->push(m_reply.data(), m_reply.numberOfBytesUsed()))
+		notify(*m_replies, m_hReplyEvent);
+
+	return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "Windows.h"
+#include "RingBuffer.h"
+#include "Serializer.h"
+#include "Transport.h"
+
+#include <string>
+#include <memory>
+
+#define SHARED_MEMORY_RING_SIZE	(64 * 1024)
+#define SHARED_MEMORY_TIMEOUT	1000
+
+// Request/reply transport between one client process and the server over a named file mapping.
+// The mapping holds one RingBuffer for requests and one for replies, events are only signaled
+// if the other side is waiting for them.
+class SharedMemoryChannel : public Transport
+{
+public:
+	SharedMemoryChannel();
+	~SharedMemoryChannel();
+
+	static std::string nameOf(int id);
+
+	// Server side, creates the mapping and its events
+	bool create(const std::string& name);
+	// Client side, opens a mapping created by the server
+	bool open(const std::string& name);
+	void close();
+
+	bool isOpen() const;
+
+	// Largest request or reply which can be sent through the channel
+	uint32_t maxMessageSize() const;
+
+	// Client: sends a request and waits for its reply. Only one request may be in flight,
+	// if the reply doesn't arrive in time the channel is closed.
+	bool transact(Serializer& serializerIn, Serializer& serializerOut) override;
+
+	// Client: queues a one-way request without waiting for the server
+	bool post(Serializer& serializerIn) override;
+
+	// Server: handles the next request, returns false if none arrived within 'dwTimeout'
+	bool serve(const MessageCallback& callback, DWORD dwTimeout);
+
+private:
+	SharedMemoryChannel(const SharedMemoryChannel&);
+	SharedMemoryChannel& operator=(const SharedMemoryChannel&);
+
+	bool map(bool bCreate, const std::string& name);
+	bool pushRequest(Serializer& serializerIn);
+	static bool waitFor(RingBuffer& ring, HANDLE hEvent, DWORD dwTimeout);
+	static void notify(RingBuffer& ring, HANDLE hEvent);
+
+	HANDLE m_hMapping, m_hRequestEvent, m_hReplyEvent;
+	char *m_pView;
+
+	std::unique_ptr<RingBuffer> m_requests, m_replies;
+	Serializer m_reply;
+};
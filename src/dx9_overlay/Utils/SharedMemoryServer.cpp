@@ -0,0 +1,96 @@
+#include "SharedMemoryServer.h"
+
+#include <boost/thread.hpp>
+
+SharedMemoryServer::SharedMemoryServer(MessageCallback func) : m_nextId(1), m_cbCallback(func)
+{
+}
+
+SharedMemoryServer::~SharedMemoryServer()
+{
+	std::lock_guard<std::mutex> lock(m_mtx);
+
+	for (size_t i = 0; i < m_channels.size(); i++)
+		closeChannel(m_channels[i].get());
+
+	m_channels.clear();
+}
+
+int SharedMemoryServer::openChannel(DWORD dwProcessId)
+{
+	std::lock_guard<std::mutex> lock(m_mtx);
+
+	// Reuse the slots of clients which have exited, and the one this client replaces. A request
+	// sent through the replaced channel itself can't close it, its thread would have to join itself.
+	for (size_t i = 0; i < m_channels.size();)
+	{
+		Channel *old = m_channels[i].get();
+		bool bReplaced = old->dwProcessId == dwProcessId && old->thread->get_id() != boost::this_thread::get_id();
+
+		if (old->finished || bReplaced)
+		{
+			closeChannel(old);
+			m_channels.erase(m_channels.begin() + i);
+		}
+		else
+			i++;
+	}
+
+	if (m_channels.size() >= MAX_SHARED_CHANNELS)
+		return 0;
+
+	std::unique_ptr<Channel> channel(new Channel);
+	channel->thread = nullptr;
+	channel->finished = false;
+	channel->dwProcessId = dwProcessId;
+
+	channel->hProcess = OpenProcess(SYNCHRONIZE, FALSE, dwProcessId);
+	if (channel->hProcess == NULL)
+		return 0;
+
+	int id = m_nextId++;
+	if (!channel->channel.create(SharedMemoryChannel::nameOf(id)))
+	{
+		CloseHandle(channel->hProcess);
+		return 0;
+	}
+
+	channel->thread = new boost::thread(boost::bind(&SharedMemoryServer::thread, this, channel.get()));
+	m_channels.push_back(std::move(channel));
+
+	return id;
+}
+
+void SharedMemoryServer::thread(Channel *channel)
+{
+	try
+	{
+		while (WaitForSingleObject(channel->hProcess, 0) == WAIT_TIMEOUT)
+		{
+			boost::this_thread::interruption_point();
+
+			channel->channel.serve(m_cbCallback, SHARED_POLL_TIME);
+		}
+	}
+	catch (boost::thread_interrupted&)
+	{
+	}
+
+	channel->finished = true;
+}
+
+void SharedMemoryServer::closeChannel(Channel *channel)
+{
+	if (channel->thread)
+	{
+		channel->thread->interrupt();
+		if (channel->thread->joinable())
+			channel->thread->join();
+
+		delete channel->thread;
+		channel->thread = nullptr;
+	}
+
+	channel->channel.close();
+	CloseHandle(channel->hProcess);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Windows.h"
+#include "SharedMemoryChannel.h"
+#include "Transport.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define MAX_SHARED_CHANNELS	4
+#define SHARED_POLL_TIME	500
+
+namespace boost { class thread; }
+
+// Serves the SharedMemoryChannels which clients open through PipeMessages::OpenSharedMemory,
+// every channel has its own thread. A channel is closed once its client process has exited or
+// opens another one. A client only opens a channel when it starts a new session, so it never
+// uses the previous one again and the requests still queued there are dropped.
+class SharedMemoryServer
+{
+	struct Channel
+	{
+		SharedMemoryChannel channel;
+		HANDLE hProcess;
+		DWORD dwProcessId;
+		boost::thread *thread;
+		std::atomic<bool> finished;
+	};
+
+public:
+	SharedMemoryServer(MessageCallback func);
+	~SharedMemoryServer();
+
+	// Creates a channel for a client process and returns its id, 0 on failure
+	int openChannel(DWORD dwProcessId);
+
+private:
+	void thread(Channel *channel);
+	void closeChannel(Channel *channel);
+
+	std::vector<std::unique_ptr<Channel> > m_channels;
+	std::mutex m_mtx;
+	int m_nextId;
+
+	MessageCallback m_cbCallback;
+};
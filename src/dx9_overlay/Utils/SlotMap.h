@@ -0,0 +1,162 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+// Values stored densely in a vector, addressed by handles which stay valid until the value is
+// erased. A handle is a slot index tagged with the slot's generation, which changes whenever
+// the slot is freed, so a stale handle never finds the value which reused its slot.
+//
+// Handles are non-negative ints: the low IndexBits are the slot, the bits above the generation.
+// insert, find and erase are O(1), erasing moves the last value into the gap.
+template<typename T>
+class SlotMap
+{
+	static const unsigned int Vacant = 0xFFFFFFFF;
+
+	struct Slot
+	{
+		unsigned int generation;
+		unsigned int index;			// into _values, Vacant while the slot is free
+		unsigned int nextFree;
+	};
+
+public:
+	typedef int Handle;
+	typedef typename std::vector<T>::iterator iterator;
+
+	enum { IndexBits = 20, GenerationBits = 11, MaxSize = 1 << IndexBits };
+
+	SlotMap() : _freeHead(Vacant)
+	{
+	}
+
+	// -1 if all slots are in use
+	Handle insert(T value)
+	{
+		unsigned int slot = _freeHead;
+		if (slot != Vacant)
+			_freeHead = _slots[slot].nextFree;
+		else
+		{
+			if (_slots.size() >= MaxSize)
+				return -1;
+
+			Slot empty;
+			empty.generation = 0;
+			empty.nextFree = Vacant;
+
+			slot = (unsigned int) _slots.size();
+			_slots.push_back(empty);
+		}
+
+		_slots[slot].index = (unsigned int) _values.size();
+		_values.push_back(std::move(value));
+		_slotOf.push_back(slot);
+
+		return handle(slot);
+	}
+
+	T *find(Handle handle)
+	{
+		Slot *slot = lookup(handle);
+		return slot ? &_values[slot->index] : nullptr;
+	}
+
+	const T *find(Handle handle) const
+	{
+		return const_cast<SlotMap *>(this)->find(handle);
+	}
+
+	bool erase(Handle handle)
+	{
+		Slot *slot = lookup(handle);
+		if (!slot)
+			return false;
+
+		eraseAt(slot->index);
+		return true;
+	}
+
+	// Erases every value for which pred(handle, value) returns true
+	template<typename Pred>
+	void erase_if(Pred pred)
+	{
+		for (size_t i = 0; i < _values.size();)
+		{
+			if (pred(handle(_slotOf[i]), _values[i]))
+				eraseAt(i);
+			else
+				i++;
+		}
+	}
+
+	iterator begin()
+	{
+		return _values.begin();
+	}
+
+	iterator end()
+	{
+		return _values.end();
+	}
+
+	size_t size() const
+	{
+		return _values.size();
+	}
+
+	bool empty() const
+	{
+		return _values.empty();
+	}
+
+private:
+	Handle handle(unsigned int slot) const
+	{
+		return Handle(slot | (_slots[slot].generation << IndexBits));
+	}
+
+	Slot *lookup(Handle handle)
+	{
+		if (handle < 0)
+			return nullptr;
+
+		unsigned int slot = (unsigned int) handle & (MaxSize - 1);
+		if (slot >= _slots.size())
+			return nullptr;
+
+		Slot& entry = _slots[slot];
+		if (entry.index == Vacant || entry.generation != ((unsigned int) handle >> IndexBits))
+			return nullptr;
+
+		return &entry;
+	}
+
+	void eraseAt(size_t index)
+	{
+		unsigned int slot = _slotOf[index];
+		size_t last = _values.size() - 1;
+
+		if (index != last)
+		{
+			_values[index] = std::move(_values[last]);
+			_slotOf[index] = _slotOf[last];
+			_slots[_slotOf[index]].index = (unsigned int) index;
+		}
+
+		_values.pop_back();
+		_slotOf.pop_back();
+
+		Slot& entry = _slots[slot];
+		entry.index = Vacant;
+		entry.generation = (entry.generation + 1) & ((1 << GenerationBits) - 1);
+		entry.nextFree = _freeHead;
+		_freeHead = slot;
+	}
+
+	std::vector<T> _values;
+	std::vector<unsigned int> _slotOf;		// slot of each value
+	std::vector<Slot> _slots;
+	unsigned int _freeHead;
+};
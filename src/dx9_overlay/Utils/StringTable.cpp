@@ -0,0 +1,105 @@
+#include "StringTable.h"
+
+#include <algorithm>
+
+StringTable::StringTable(size_t maxEntries) : m_maxEntries(std::min<size_t>(maxEntries, MaxEntries))
+{
+}
+
+int StringTable::intern(boost::string_ref str)
+{
+	std::lock_guard<std::mutex> lock(m_mtx);
+
+	auto it = m_handles.find(str);
+	if (it != m_handles.end())
+	{
+		find(it->second)->references++;
+		return it->second;
+	}
+
+	size_t slot;
+	if (!m_freeSlots.empty())
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		if (m_entries.size() >= m_maxEntries)
+			return 0;
+
+		Entry entry;
+		entry.references = 0;
+		entry.generation = 0;
+
+		slot = m_entries.size();
+		m_entries.push_back(entry);
+	}
+
+	Entry& entry = m_entries[slot];
+	entry.str.assign(str.begin(), str.end());
+	entry.references = 1;
+
+	int handle = handleOf(slot);
+	m_handles[boost::string_ref(entry.str)] = handle;
+
+	return handle;
+}
+
+bool StringTable::release(int handle)
+{
+	std::lock_guard<std::mutex> lock(m_mtx);
+
+	Entry *entry = find(handle);
+	if (!entry)
+		return false;
+
+	if (--entry->references > 0)
+		return true;
+
+	m_handles.erase(boost::string_ref(entry->str));
+	std::string().swap(entry->str);
+	entry->generation = (entry->generation + 1) & GenerationMask;
+
+	m_freeSlots.push_back(size_t(handle & ((1 << SlotBits) - 1)) - 1);
+	return true;
+}
+
+bool StringTable::lookup(int handle, std::string& str) const
+{
+	std::lock_guard<std::mutex> lock(m_mtx);
+
+	const Entry *entry = const_cast<StringTable *>(this)->find(handle);
+	if (!entry)
+		return false;
+
+	str = entry->str;
+	return true;
+}
+
+size_t StringTable::size() const
+{
+	std::lock_guard<std::mutex> lock(m_mtx);
+	return m_handles.size();
+}
+
+StringTable::Entry *StringTable::find(int handle)
+{
+	if (handle <= 0)
+		return nullptr;
+
+	size_t slot = size_t(handle & ((1 << SlotBits) - 1));
+	if (slot == 0 || slot > m_entries.size())
+		return nullptr;
+
+	Entry& entry = m_entries[slot - 1];
+	if (entry.references == 0 || entry.generation != ((unsigned int) handle >> SlotBits))
+		return nullptr;
+
+	return &entry;
+}
+
+int StringTable::handleOf(size_t slot) const
+{
+	return int((m_entries[slot].generation << SlotBits) | (slot + 1));
+}
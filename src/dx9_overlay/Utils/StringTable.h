@@ -0,0 +1,66 @@
+#pragma once
+#include <boost/utility/string_ref.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+// Maps strings to small integer handles, 0 is never a valid handle. Every intern() counts a
+// reference, the string is removed once release() has dropped the last one. Its slot is reused
+// by a later string, but with another handle, so a released handle never finds that string.
+class StringTable
+{
+public:
+	enum { MaxEntries = 0xFFFF };
+
+	// At most MaxEntries
+	explicit StringTable(size_t maxEntries);
+
+	// Returns the handle of 'str', adding it if necessary. Returns 0 if the table is full.
+	int intern(boost::string_ref str);
+
+	// Drops a reference taken by intern(), fails for handles which aren't valid
+	bool release(int handle);
+
+	// Copies the string of a handle, fails for handles which aren't valid. Copied, because
+	// another client may release the handle as soon as the table is unlocked.
+	bool lookup(int handle, std::string& str) const;
+
+	size_t size() const;
+
+private:
+	// A handle is the slot + 1 in the low SlotBits, the slot's generation above
+	enum { SlotBits = 16, GenerationMask = 0x7FFF };
+
+	struct Entry
+	{
+		std::string str;
+		int references;
+		unsigned int generation;
+	};
+
+	struct Hash
+	{
+		size_t operator()(boost::string_ref str) const
+		{
+			return boost::hash_range(str.begin(), str.end());
+		}
+	};
+
+	StringTable(const StringTable&);
+	StringTable& operator=(const StringTable&);
+
+	Entry *find(int handle);
+	int handleOf(size_t slot) const;
+
+	// A deque never moves its elements, so the map keys stay valid
+	std::deque<Entry> m_entries;
+	std::vector<size_t> m_freeSlots;
+	std::unordered_map<boost::string_ref, int, Hash> m_handles;
+
+	size_t m_maxEntries;
+	mutable std::mutex m_mtx;
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include "Serializer.h"
+
+#include <boost/function.hpp>
+
+// Decodes a request, handles it and encodes the reply. Every server side transport
+// (PipeServer, SharedMemoryServer, LoopbackTransport) delivers its requests to one of these.
+typedef boost::function<void(Serializer&, Serializer&)> MessageCallback;
+
+// Client side of a connection to the message dispatcher
+class Transport
+{
+public:
+	virtual ~Transport() {}
+
+	// Sends a request and waits for its reply
+	virtual bool transact(Serializer& serializerIn, Serializer& serializerOut) = 0;
+
+	// Sends a one-way request, returns as soon as it has been queued
+	virtual bool post(Serializer& serializerIn) = 0;
+};
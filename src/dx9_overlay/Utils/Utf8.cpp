@@ -0,0 +1,88 @@
+#include "Windows.h"
+#include "Utf8.h"
+
+#include <cstring>
+#include <cwchar>
+
+static bool isAscii(boost::string_ref str)
+{
+	for (auto it = str.begin(); it != str.end(); ++it)
+	{
+		if ((unsigned char) *it >= 0x80)
+			return false;
+	}
+
+	return true;
+}
+
+static std::wstring multiByteToWide(UINT codePage, boost::string_ref str)
+{
+	if (str.empty())
+		return std::wstring();
+
+	int length = MultiByteToWideChar(codePage, 0, str.data(), (int) str.length(), NULL, 0);
+	if (length <= 0)
+		return std::wstring();
+
+	std::wstring wide(length, L'\0');
+	MultiByteToWideChar(codePage, 0, str.data(), (int) str.length(), &wide[0], length);
+
+	return wide;
+}
+
+std::string ansiToUtf8(boost::string_ref str)
+{
+	if (isAscii(str))
+		return str.to_string();
+
+	std::wstring wide = multiByteToWide(CP_ACP, str);
+	return wideToUtf8(wide.data(), wide.length());
+}
+
+std::string wideToUtf8(const wchar_t *str, size_t length)
+{
+	if (length == 0)
+		return std::string();
+
+	int size = WideCharToMultiByte(CP_UTF8, 0, str, (int) length, NULL, 0, NULL, NULL);
+	if (size <= 0)
+		return std::string();
+
+	std::string utf8(size, '\0');
+	WideCharToMultiByte(CP_UTF8, 0, str, (int) length, &utf8[0], size, NULL, NULL);
+
+	return utf8;
+}
+
+std::wstring utf8ToWide(boost::string_ref str)
+{
+	return multiByteToWide(CP_UTF8, str);
+}
+
+Utf8String::Utf8String(const char *ansi)
+{
+	boost::string_ref str(ansi ? ansi : "");
+
+	if (isAscii(str))
+	{
+		m_view = str;
+	}
+	else
+	{
+		m_storage = ansiToUtf8(str);
+		m_view = m_storage;
+	}
+}
+
+Utf8String::Utf8String(const wchar_t *wide)
+{
+	if (wide)
+		m_storage = wideToUtf8(wide, wcslen(wide));
+
+	m_view = m_storage;
+}
+
+Utf8String::operator boost::string_ref() const
+{
+	return m_view;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <boost/utility/string_ref.hpp>
+
+#include <string>
+
+// UTF-8 is the encoding of every string on the wire and of the text stored by the renderer.
+
+// Decodes the code point at 'it' and advances past it.
+// Malformed sequences yield U+FFFD and skip a single byte.
+inline unsigned int utf8Decode(const char *&it, const char *end)
+{
+	unsigned char lead = (unsigned char) *it++;
+	if (lead < 0x80)
+		return lead;
+
+	int length = (lead >= 0xF0) ? 3 : (lead >= 0xE0) ? 2 : (lead >= 0xC0) ? 1 : -1;
+	if (length < 0 || lead > 0xF4 || end - it < length)
+		return 0xFFFD;
+
+	unsigned int codePoint = lead & (0x3F >> length);
+	for (int i = 0; i < length; i++)
+	{
+		unsigned char next = (unsigned char) it[i];
+		if ((next & 0xC0) != 0x80)
+			return 0xFFFD;
+
+		codePoint = (codePoint << 6) | (next & 0x3F);
+	}
+
+	// Overlong encodings, UTF-16 surrogates and values beyond U+10FFFF aren't characters
+	static const unsigned int minimum[] = { 0, 0x80, 0x800, 0x10000 };
+	if (codePoint < minimum[length] || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+		return 0xFFFD;
+
+	it += length;
+	return codePoint;
+}
+
+std::string ansiToUtf8(boost::string_ref str);
+std::string wideToUtf8(const wchar_t *str, size_t length);
+std::wstring utf8ToWide(boost::string_ref str);
+
+// Argument adapter for the ANSI and UTF-16 exports: views the string as UTF-8,
+// only strings with non-ASCII characters are converted into an own buffer.
+class Utf8String
+{
+public:
+	explicit Utf8String(const char *ansi);
+	explicit Utf8String(const wchar_t *wide);
+
+	operator boost::string_ref() const;
+
+private:
+	Utf8String(const Utf8String&);
+	Utf8String& operator=(const Utf8String&);
+
+	std::string m_storage;
+	boost::string_ref m_view;
+};
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdio>
+
+// Minimal assertions for the tests, a failed CHECK is reported and counted but doesn't stop the test
+static int g_checkFailures = 0;
+
+#define CHECK(x)																\
+	do																			\
+	{																			\
+		if (!(x))																\
+		{																		\
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x);	\
+			g_checkFailures++;													\
+		}																		\
+	} while (0)
+
+// Exit code of a test's main()
+#define CHECK_RESULT() (g_checkFailures == 0 ? 0 : 1)
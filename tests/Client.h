@@ -0,0 +1,37 @@
+#pragma once
+#include <Utils/Transport.h>
+#include <Shared/MessageSchema.h>
+
+#include <utility>
+
+// Encodes M like the client API does and waits for the reply, which is left in serializerOut
+template<PipeMessages M, typename ...A>
+bool request(Transport& transport, Serializer& serializerOut, A&&... args)
+{
+	Serializer serializerIn;
+	encodeMessage<M>(serializerIn, std::forward<A>(args)...);
+
+	return transport.transact(serializerIn, serializerOut);
+}
+
+// Like request(), for the replies which are read right away
+template<PipeMessages M, typename ...A>
+typename MessageSchema<M>::Reply call(Transport& transport, A&&... args)
+{
+	Serializer serializerOut;
+	typename MessageSchema<M>::Reply reply = typename MessageSchema<M>::Reply();
+
+	if (request<M>(transport, serializerOut, std::forward<A>(args)...))
+		serializerOut >> reply;
+
+	return reply;
+}
+
+template<PipeMessages M, typename ...A>
+bool post(Transport& transport, A&&... args)
+{
+	Serializer serializerIn;
+	encodeOneWayMessage<M>(serializerIn, std::forward<A>(args)...);
+
+	return transport.post(serializerIn);
+}
@@ -0,0 +1,142 @@
+#include "Client.h"
+
+#include <Utils/LoopbackTransport.h>
+#include <Game/Game.h>
+#include <Game/Dispatcher.h>
+#include <Game/Rendering/Renderer.h>
+#include <Game/Rendering/RecordingDevice.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#define SCENE_OBJECTS	100
+#define BATCH_OBJECTS	32
+
+typedef std::chrono::steady_clock Clock;
+
+// A client which moves and recolors part of the scene once per frame, like a script updating
+// its display. Now and then it creates and destroys an object and hides and shows everything.
+static void client(int index, const std::vector<int>& texts, const std::vector<int>& boxes,
+	std::atomic<bool>& bStop, std::atomic<int>& frame, std::atomic<long long>& requests)
+{
+	LoopbackTransport transport(&dispatchRequest);
+	Serializer serializerOut;
+
+	long long count = 0;
+	for (int batch = 0; !bStop; batch++)
+	{
+		for (int i = 0; i < BATCH_OBJECTS; i++)
+		{
+			int object = (batch * BATCH_OBJECTS + i + index * 7) % SCENE_OBJECTS;
+
+			post<PipeMessages::TextSetPos>(transport, texts[object], batch % 640, i * 4);
+			post<PipeMessages::BoxSetColor>(transport, boxes[object], 0xFF000000u | batch);
+		}
+
+		request<PipeMessages::TextSetString>(transport, serializerOut, texts[index % SCENE_OBJECTS], boost::string_ref("{FFFFFF}Health: {FF0000}100"));
+		call<PipeMessages::Sync>(transport);
+		count += BATCH_OBJECTS * 2 + 2;
+
+		if (batch % 16 == 0)
+		{
+			int box = call<PipeMessages::BoxCreate>(transport, batch % 640, 100, 20, 20, 0xFF00FF00u, true);
+			call<PipeMessages::BoxDestroy>(transport, box);
+			count += 2;
+		}
+
+		if (batch % 64 == 0)
+		{
+			request<PipeMessages::HideAllVisual>(transport, serializerOut);
+			request<PipeMessages::ShowAllVisual>(transport, serializerOut);
+			count += 2;
+		}
+
+		// The next batch belongs to the next frame
+		int current = frame;
+		while (frame == current && !bStop)
+			std::this_thread::yield();
+	}
+
+	requests += count;
+}
+
+// Draws 'frames' frames while 'clients' clients send a batch of requests per frame, prints the
+// time spent in Renderer::draw
+static void measure(int clients, int frames)
+{
+	LoopbackTransport transport(&dispatchRequest);
+	RecordingDevice device;
+
+	std::vector<int> texts, boxes;
+	for (int i = 0; i < SCENE_OBJECTS; i++)
+	{
+		texts.push_back(call<PipeMessages::TextCreate>(transport, boost::string_ref("Arial"), 12, false, false, i * 6, 10,
+			0xFFFFFFFFu, boost::string_ref("text"), true, true));
+		boxes.push_back(call<PipeMessages::BoxCreate>(transport, i * 6, 40, 5, 5, 0xFF00FF00u, true));
+	}
+
+	g_pRenderer.draw(&device);
+
+	std::atomic<bool> bStop(false);
+	std::atomic<int> frame(0);
+	std::atomic<long long> requests(0);
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < clients; i++)
+		threads.emplace_back(client, i, std::cref(texts), std::cref(boxes), std::ref(bStop), std::ref(frame), std::ref(requests));
+
+	std::vector<double> times;
+	times.reserve(frames);
+
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < frames; i++)
+	{
+		device.clear();
+
+		Clock::time_point begin = Clock::now();
+		g_pRenderer.draw(&device);
+		times.push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+
+		frame++;
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	bStop = true;
+	for (auto& thread : threads)
+		thread.join();
+
+	Serializer serializerOut;
+	request<PipeMessages::DestroyAllVisual>(transport, serializerOut);
+	g_pRenderer.draw(&device);
+
+	std::sort(times.begin(), times.end());
+
+	double total = 0;
+	for (double time : times)
+		total += time;
+
+	std::printf("%2d clients  mean %7.1f us  p99 %7.1f us  max %8.1f us  %9.0f requests/s\n", clients,
+		total / frames, times[frames * 99 / 100], times.back(), requests / seconds);
+}
+
+// Frame times of a scene of texts and boxes on a RecordingDevice, while clients send requests
+// through LoopbackTransports to the real dispatcher. The clients and the render thread share
+// the cores, the times include waiting for them.
+// Argument: number of frames per measurement
+int main(int argc, char *argv[])
+{
+	int frames = argc > 1 ? std::atoi(argv[1]) : 5000;
+	if (frames <= 0)
+		return 1;
+
+	const int clients[] = { 0, 1, 4, 16 };
+	for (int count : clients)
+		measure(count, frames);
+
+	return 0;
+}
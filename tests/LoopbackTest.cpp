@@ -0,0 +1,292 @@
+#include "Check.h"
+#include "Client.h"
+
+#include <Utils/LoopbackTransport.h>
+#include <Game/Game.h>
+#include <Game/Dispatcher.h>
+#include <Game/Rendering/Renderer.h>
+#include <Game/Rendering/RecordingDevice.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+// Requests of the client API, decoded and applied by the real dispatcher and drawn on a RecordingDevice
+static void testDispatch()
+{
+	LoopbackTransport transport(&dispatchRequest);
+	RecordingDevice device;
+
+	ServerInfo info = call<PipeMessages::Handshake>(transport, PROTOCOL_VERSION);
+	CHECK(info.protocolVersion == PROTOCOL_VERSION);
+	CHECK(info.maxMessageSize == PROTOCOL_MAX_MESSAGE_SIZE);
+	CHECK((info.features & FeatureOneWay) != 0);
+
+	// A client of another version only learns the server's
+	ServerInfo refused = call<PipeMessages::Handshake>(transport, PROTOCOL_VERSION + 1);
+	CHECK(refused.protocolVersion == PROTOCOL_VERSION);
+	CHECK(refused.encodings == 0 && refused.features == 0);
+
+	int text = call<PipeMessages::TextCreate>(transport, boost::string_ref("Arial"), 12, false, false, 10, 10, 0xFFFFFFFFu,
+		boost::string_ref("text"), false, true);
+	int box = call<PipeMessages::BoxCreate>(transport, 10, 10, 100, 50, 0xFF00FF00u, true);
+	CHECK(text >= 0 && box >= 0 && text != box);
+
+	g_pRenderer.draw(&device);
+	CHECK(device.counts().drawCalls == 2);
+
+	CHECK(call<PipeMessages::BoxSetBorder>(transport, box, 2, true) == 1);
+	CHECK(call<PipeMessages::TextSetShown>(transport, -1, true) == 0);
+
+	device.clear();
+	g_pRenderer.draw(&device);
+	CHECK(device.counts().drawCalls == 6);
+
+	// Failed one-way setters are counted until the next Sync
+	for (int i = 0; i < 100; i++)
+		CHECK(post<PipeMessages::TextSetPos>(transport, text, i, i));
+
+	CHECK(post<PipeMessages::BoxSetShown>(transport, box + 1000, false));
+	CHECK(call<PipeMessages::Sync>(transport) == 1);
+	CHECK(call<PipeMessages::Sync>(transport) == 0);
+
+	// Only the last position reaches the frame
+	g_pRenderer.draw(&device);
+	CHECK(call<PipeMessages::GetCoalescedUpdates>(transport) == 99);
+
+	// Unknown and retired ids are answered with an empty reply
+	Serializer serializerIn, serializerOut;
+	serializerIn << PipeMessages::ReservedTextSetStringUnicode << text;
+	CHECK(transport.transact(serializerIn, serializerOut));
+	CHECK(serializerOut.numberOfBytesUsed() == 0);
+
+	serializerIn.clear();
+	serializerIn << PipeMessages(0x0FFF);
+	CHECK(transport.transact(serializerIn, serializerOut));
+	CHECK(serializerOut.numberOfBytesUsed() == 0);
+
+	CHECK(call<PipeMessages::TextDestroy>(transport, text) == 1);
+	CHECK(call<PipeMessages::BoxDestroy>(transport, box) == 1);
+
+	device.clear();
+	g_pRenderer.draw(&device);
+	CHECK(device.counts().drawCalls == 0);
+	CHECK(device.counts().resourcesAlive == 0);
+}
+
+// A one-way request can carry a request id as well, its result is counted like any other one's
+static void testTaggedOneWay()
+{
+	LoopbackTransport transport(&dispatchRequest);
+
+	int box = call<PipeMessages::BoxCreate>(transport, 10, 10, 100, 50, 0xFF00FF00u, true);
+	CHECK(box >= 0);
+	CHECK(call<PipeMessages::Sync>(transport) == 0);
+
+	const unsigned int requestIds[] = { 0, 7 };
+	for (unsigned int requestId : requestIds)
+	{
+		Serializer serializerIn;
+		serializerIn << PipeMessages(short(PipeMessages::BoxSetColor) | PROTOCOL_ONE_WAY_FLAG | PROTOCOL_REQUEST_ID_FLAG) << requestId << box << 0xFF0000FFu;
+		CHECK(transport.post(serializerIn));
+		CHECK(call<PipeMessages::Sync>(transport) == 0);
+
+		serializerIn.clear();
+		serializerIn << PipeMessages(short(PipeMessages::BoxSetColor) | PROTOCOL_ONE_WAY_FLAG | PROTOCOL_REQUEST_ID_FLAG) << requestId << box + 1000 << 0xFF0000FFu;
+		CHECK(transport.post(serializerIn));
+		CHECK(call<PipeMessages::Sync>(transport) == 1);
+	}
+
+	CHECK(call<PipeMessages::BoxDestroy>(transport, box) == 1);
+}
+
+// Objects are drawn by priority, objects of the same priority in the order they were added
+static void testDrawOrder()
+{
+	LoopbackTransport transport(&dispatchRequest);
+	RecordingDevice device;
+
+	typedef std::vector<unsigned int> Colors;
+	const unsigned int a = 0xFF000001, b = 0xFF000002, c = 0xFF000003, d = 0xFF000004, e = 0xFF000005;
+
+	int boxA = call<PipeMessages::BoxCreate>(transport, 0, 0, 10, 10, a, true);
+	int boxB = call<PipeMessages::BoxCreate>(transport, 0, 0, 10, 10, b, true);
+	int boxC = call<PipeMessages::BoxCreate>(transport, 0, 0, 10, 10, c, true);
+	call<PipeMessages::BoxCreate>(transport, 0, 0, 10, 10, d, true);
+
+	g_pRenderer.draw(&device);
+	CHECK(device.stripColors() == Colors({ a, b, c, d }));
+
+	CHECK(call<PipeMessages::SetOverlayPriority>(transport, boxC, -1) == 1);
+	CHECK(call<PipeMessages::SetOverlayPriority>(transport, boxA, 5) == 1);
+
+	device.clear();
+	g_pRenderer.draw(&device);
+	CHECK(device.stripColors() == Colors({ c, b, d, a }));
+
+	// A new object goes behind the ones of its priority
+	call<PipeMessages::BoxCreate>(transport, 0, 0, 10, 10, e, true);
+
+	device.clear();
+	g_pRenderer.draw(&device);
+	CHECK(device.stripColors() == Colors({ c, b, d, e, a }));
+
+	// Back at the same priority, the objects are in the order they were added again
+	CHECK(call<PipeMessages::SetOverlayPriority>(transport, boxC, 0) == 1);
+
+	device.clear();
+	g_pRenderer.draw(&device);
+	CHECK(device.stripColors() == Colors({ b, c, d, e, a }));
+
+	// Only the last priority of a frame counts
+	CHECK(call<PipeMessages::SetOverlayPriority>(transport, boxB, 10) == 1);
+	CHECK(call<PipeMessages::SetOverlayPriority>(transport, boxB, 0) == 1);
+	CHECK(call<PipeMessages::SetOverlayPriority>(transport, boxA, 0) == 1);
+
+	device.clear();
+	g_pRenderer.draw(&device);
+	CHECK(device.stripColors() == Colors({ a, b, c, d, e }));
+
+	Serializer serializerOut;
+	CHECK(request<PipeMessages::DestroyAllVisual>(transport, serializerOut));
+
+	device.clear();
+	g_pRenderer.draw(&device);
+	CHECK(device.counts().drawCalls == 0);
+	CHECK(device.counts().resourcesAlive == 0);
+}
+
+// A bulk update goes through Renderer::setProperties, its properties are applied with the next frame
+static void testBulkUpdate()
+{
+	LoopbackTransport transport(&dispatchRequest);
+	RecordingDevice device;
+
+	int box = call<PipeMessages::BoxCreate>(transport, 10, 10, 100, 50, 0xFF00FF00u, true);
+	int line = call<PipeMessages::LineCreate>(transport, 0, 0, 10, 10, 1, 0xFF00FF00u, true);
+
+	g_pRenderer.draw(&device);
+	CHECK(device.stripColors() == std::vector<unsigned int>({ 0xFF00FF00u }));
+
+	// The unknown object and the property a Box doesn't have fail, the other records are applied
+	const int records[][3] = {
+		{ box, PropertyColor, (int) 0xFF0000FFu },
+		{ box, PropertyBorderShown, 1 },
+		{ box, PropertyBorderColor, (int) 0xFFFF0000u },
+		{ box, PropertyRotation, 90 },
+		{ line, PropertyShown, 0 },
+		{ box + 1000, PropertyColor, 0 },
+	};
+
+	Serializer encoded;
+	for (auto& record : records)
+		encoded << record[0] << record[1] << record[2];
+
+	CHECK(call<PipeMessages::BulkUpdate>(transport, 6, boost::string_ref(encoded.data(), encoded.numberOfBytesUsed())) == 2);
+
+	// The box and its four border strips, the line is hidden
+	device.clear();
+	g_pRenderer.draw(&device);
+	CHECK(device.stripColors() == std::vector<unsigned int>({ 0xFF0000FFu, 0xFFFF0000u, 0xFFFF0000u, 0xFFFF0000u, 0xFFFF0000u }));
+	CHECK(device.counts().drawCalls == 5);
+
+	// More records than the payload can hold
+	CHECK(call<PipeMessages::BulkUpdate>(transport, 100, boost::string_ref(encoded.data(), encoded.numberOfBytesUsed())) == 100);
+
+	CHECK(call<PipeMessages::BoxDestroy>(transport, box) == 1);
+	CHECK(call<PipeMessages::LineDestroy>(transport, line) == 1);
+
+	device.clear();
+	g_pRenderer.draw(&device);
+	CHECK(device.counts().resourcesAlive == 0);
+}
+
+// Requests which are still queued when the transport is destroyed fail, their transact() returns
+// before the destructor does. The request being handled is completed.
+static void testStop()
+{
+	std::promise<void> release;
+	std::shared_future<void> released = release.get_future().share();
+	std::atomic<int> handled(0);
+
+	LoopbackTransport *transport = new LoopbackTransport([&](Serializer&, Serializer& serializerOut)
+	{
+		handled++;
+		released.wait();
+		serializerOut << 1;
+	});
+
+	std::atomic<int> started(0);
+	auto transact = [&]() -> bool
+	{
+		Serializer serializerIn, serializerOut;
+		serializerIn << PipeMessages::Ping;
+
+		started++;
+		return transport->transact(serializerIn, serializerOut);
+	};
+
+	// The first request blocks the thread, the second one stays queued
+	std::future<bool> first = std::async(std::launch::async, transact);
+	while (handled == 0)
+		std::this_thread::yield();
+
+	std::future<bool> second = std::async(std::launch::async, transact);
+	while (started < 2)
+		std::this_thread::yield();
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	std::future<void> destroyed = std::async(std::launch::async, [&]() { delete transport; });
+	CHECK(destroyed.wait_for(std::chrono::milliseconds(20)) == std::future_status::timeout);
+
+	release.set_value();
+	destroyed.wait();
+
+	CHECK(first.get());
+	CHECK(!second.get());
+	CHECK(handled == 1);
+}
+
+// Interned fonts stay usable until the last reference is released
+static void testInternedStrings()
+{
+	LoopbackTransport transport(&dispatchRequest);
+	RecordingDevice device;
+
+	int font = call<PipeMessages::StringIntern>(transport, boost::string_ref("Arial"));
+	CHECK(font > 0);
+	CHECK(call<PipeMessages::StringIntern>(transport, boost::string_ref("Arial")) == font);
+
+	int text = call<PipeMessages::TextCreateInterned>(transport, font, 12, false, false, 10, 10, 0xFFFFFFFFu,
+		boost::string_ref("text"), false, true);
+	CHECK(text >= 0);
+
+	CHECK(call<PipeMessages::StringRelease>(transport, font) == 1);
+	CHECK(call<PipeMessages::TextUpdateInterned>(transport, text, font, 14, true, false) == 1);
+
+	CHECK(call<PipeMessages::StringRelease>(transport, font) == 1);
+	CHECK(call<PipeMessages::StringRelease>(transport, font) == 0);
+	CHECK(call<PipeMessages::TextUpdateInterned>(transport, text, font, 14, true, false) == 0);
+	CHECK(call<PipeMessages::TextCreateInterned>(transport, font, 12, false, false, 10, 10, 0xFFFFFFFFu,
+		boost::string_ref("text"), false, true) == -1);
+
+	CHECK(call<PipeMessages::TextDestroy>(transport, text) == 1);
+
+	g_pRenderer.draw(&device);
+	CHECK(device.counts().resourcesAlive == 0);
+}
+
+int main()
+{
+	testDispatch();
+	testTaggedOneWay();
+	testDrawOrder();
+	testBulkUpdate();
+	testInternedStrings();
+	testStop();
+
+	return CHECK_RESULT();
+}
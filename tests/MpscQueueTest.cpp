@@ -0,0 +1,208 @@
+#include "Check.h"
+
+#include <Utils/MpscQueue.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void testSingleThread()
+{
+	MpscQueue<int> queue;
+
+	int value = -1;
+	CHECK(!queue.pop(value));
+
+	queue.push(1);
+	CHECK(queue.pop(value) && value == 1);
+	CHECK(!queue.pop(value));
+
+	// The queue stays usable after it ran empty
+	for (int i = 0; i < 10; i++)
+		queue.push(i);
+
+	for (int i = 0; i < 10; i++)
+		CHECK(queue.pop(value) && value == i);
+
+	CHECK(!queue.pop(value));
+}
+
+// Values which are left are destroyed with the queue
+static void testDestroy()
+{
+	std::shared_ptr<int> value = std::make_shared<int>(1);
+	{
+		MpscQueue<std::shared_ptr<int> > queue;
+		queue.push(value);
+		queue.push(value);
+		CHECK(value.use_count() == 3);
+	}
+
+	CHECK(value.use_count() == 1);
+}
+
+// Several producers and one consumer running at once: every value arrives exactly once and
+// the values of each producer arrive in the order it pushed them
+static void testProducers()
+{
+	const int producers = 4, count = 100000;
+
+	MpscQueue<int> queue;
+	std::atomic<int> started(0);
+
+	std::vector<std::thread> threads;
+	for (int producer = 0; producer < producers; producer++)
+	{
+		threads.emplace_back([&, producer]()
+		{
+			started++;
+			while (started < producers)
+				std::this_thread::yield();
+
+			for (int i = 0; i < count; i++)
+				queue.push(producer * count + i);
+		});
+	}
+
+	std::vector<int> next(producers, 0);
+	int received = 0, outOfOrder = 0;
+
+	while (received < producers * count)
+	{
+		int value = -1;
+		if (!queue.pop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		int producer = value / count;
+		if (producer < 0 || producer >= producers || value % count != next[producer])
+			outOfOrder++;
+		else
+			next[producer]++;
+
+		received++;
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	CHECK(outOfOrder == 0);
+	for (int producer = 0; producer < producers; producer++)
+		CHECK(next[producer] == count);
+
+	int value = -1;
+	CHECK(!queue.pop(value));
+}
+
+// A chain is only seen once it has been pushed, and then with all of its values
+static void testChain()
+{
+	MpscQueue<int> queue;
+	MpscQueue<int>::Chain chain;
+	CHECK(chain.empty());
+
+	queue.push(0);
+	queue.append(chain) = 1;
+	queue.append(chain) = 2;
+	CHECK(!chain.empty());
+
+	int value = -1;
+	CHECK(queue.pop(value) && value == 0);
+	CHECK(!queue.pop(value));
+
+	queue.push(chain);
+	CHECK(chain.empty());
+	queue.push(3);
+
+	for (int i = 1; i <= 3; i++)
+		CHECK(queue.pop(value) && value == i);
+
+	CHECK(!queue.pop(value));
+
+	// Pushing an empty chain changes nothing
+	queue.push(chain);
+	CHECK(!queue.pop(value));
+}
+
+// A popped node is reused by the next push, it holds the consumer's previous value
+static void testReuse()
+{
+	MpscQueue<std::string> queue;
+
+	std::string value(100, 'a');
+	queue.push("first");
+	CHECK(queue.pop(value) && value == "first");
+
+	MpscQueue<std::string>::Chain chain;
+	std::string& reused = queue.append(chain);
+	CHECK(reused == std::string(100, 'a'));
+
+	const char *buffer = reused.data();
+	reused.assign(50, 'b');
+	CHECK(reused.data() == buffer);
+	queue.push(chain);
+
+	CHECK(queue.pop(value) && value == std::string(50, 'b'));
+}
+
+// Chains of several producers never interleave, each arrives as a whole
+static void testChainProducers()
+{
+	const int producers = 4, chains = 20000, length = 3;
+
+	MpscQueue<int> queue;
+	std::vector<std::thread> threads;
+	for (int producer = 0; producer < producers; producer++)
+	{
+		threads.emplace_back([&, producer]()
+		{
+			for (int i = 0; i < chains; i++)
+			{
+				MpscQueue<int>::Chain chain;
+				for (int j = 0; j < length; j++)
+					queue.append(chain) = (producer * chains + i) * length + j;
+
+				queue.push(chain);
+			}
+		});
+	}
+
+	int received = 0, split = 0, previous = -1;
+	while (received < producers * chains * length)
+	{
+		int value = -1;
+		if (!queue.pop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Only the first value of a chain may follow another chain
+		if (value % length != 0 && value != previous + 1)
+			split++;
+
+		previous = value;
+		received++;
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	CHECK(split == 0);
+}
+
+int main()
+{
+	testSingleThread();
+	testDestroy();
+	testProducers();
+	testChain();
+	testReuse();
+	testChainProducers();
+
+	return CHECK_RESULT();
+}
@@ -0,0 +1,110 @@
+#include "Check.h"
+#include "Client.h"
+
+#include <Utils/LoopbackTransport.h>
+#include <Utils/OrderedTransport.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Stands in for the server, records the object id of every setter in the order they are handled
+struct Server
+{
+	void handle(Serializer& serializerIn, Serializer& serializerOut, bool bSlow)
+	{
+		// The queue is busy, a message sent the other way would be handled first
+		if (bSlow)
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+		SERIALIZATION_READ(serializerIn, PipeMessages, eMessage);
+
+		if ((short(eMessage) & ~PROTOCOL_ONE_WAY_FLAG) == short(PipeMessages::Ping))
+			return;
+
+		int id = 0;
+		serializerIn >> id;
+
+		std::lock_guard<std::mutex> lock(mtx);
+		ids.push_back(id);
+		oneWay.push_back((short(eMessage) & PROTOCOL_ONE_WAY_FLAG) != 0);
+
+		serializerOut << 1;
+	}
+
+	std::mutex mtx;
+	std::vector<int> ids;
+	std::vector<bool> oneWay;
+};
+
+static std::vector<int> sequence(int count)
+{
+	std::vector<int> ids;
+	for (int i = 0; i < count; i++)
+		ids.push_back(i);
+
+	return ids;
+}
+
+// Small posts go through the slow queue, large requests and posts through the fallback
+static void testOrder()
+{
+	Server server;
+	LoopbackTransport queue([&](Serializer& in, Serializer& out) { server.handle(in, out, true); });
+	LoopbackTransport fallback([&](Serializer& in, Serializer& out) { server.handle(in, out, false); });
+
+	std::mutex queueMutex;
+	OrderedTransport transport(queue, []() { return 32u; }, queueMutex, fallback);
+
+	const std::string large(100, 'x');
+	int id = 0;
+
+	for (int i = 0; i < 5; i++)
+		CHECK(post<PipeMessages::TextSetShown>(transport, id++, true));
+
+	CHECK(call<PipeMessages::TextSetString>(transport, id++, boost::string_ref(large)) == 1);
+
+	for (int i = 0; i < 5; i++)
+		CHECK(post<PipeMessages::TextSetShown>(transport, id++, true));
+
+	CHECK(post<PipeMessages::TextSetString>(transport, id++, boost::string_ref(large)));
+	CHECK(post<PipeMessages::TextSetShown>(transport, id++, true));
+
+	// Handled after everything before it
+	CHECK(call<PipeMessages::TextSetColor>(transport, id++, 0xFFFFFFFFu) == 1);
+
+	std::lock_guard<std::mutex> lock(server.mtx);
+	CHECK(server.ids == sequence(id));
+
+	// The large post was sent as a request, the small ones one-way
+	CHECK(server.oneWay.size() == 14 && !server.oneWay[5] && !server.oneWay[11] && server.oneWay[12]);
+	CHECK(!server.oneWay[13]);
+}
+
+// A closed queue isn't drained, everything goes through the fallback as it is
+static void testClosedQueue()
+{
+	Server server;
+	LoopbackTransport queue([&](Serializer& in, Serializer& out) { server.handle(in, out, true); });
+	LoopbackTransport fallback([&](Serializer& in, Serializer& out) { server.handle(in, out, false); });
+
+	std::mutex queueMutex;
+	OrderedTransport transport(queue, []() { return 0u; }, queueMutex, fallback);
+
+	CHECK(post<PipeMessages::TextSetString>(transport, 0, boost::string_ref(std::string(100, 'x'))));
+	CHECK(call<PipeMessages::TextSetShown>(transport, 1, true) == 1);
+
+	std::lock_guard<std::mutex> lock(server.mtx);
+	CHECK(server.ids == sequence(2));
+	CHECK(server.oneWay.size() == 2 && server.oneWay[0] && !server.oneWay[1]);
+}
+
+int main()
+{
+	testOrder();
+	testClosedQueue();
+
+	return CHECK_RESULT();
+}
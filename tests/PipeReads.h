@@ -0,0 +1,34 @@
+#pragma once
+#include <Utils/ServerConnection.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+// Reads a message into the connection like a pipe in message mode: as much as fits, the rest
+// is continued. With bKnownLength the reader learns how much is left, like PeekNamedPipe tells
+// the server.
+inline bool deliver(ServerConnection& connection, const char *data, size_t size, bool bKnownLength)
+{
+	size_t offset = 0;
+	while (true)
+	{
+		uint32_t bytes = (uint32_t) std::min<size_t>(connection.readSpace(), size - offset);
+		memcpy(connection.readBuffer(), data + offset, bytes);
+		offset += bytes;
+
+		if (offset == size)
+		{
+			connection.completeRequest(bytes);
+			return true;
+		}
+
+		if (!connection.continueRequest(bytes, bKnownLength ? uint32_t(size - offset) : 0))
+			return false;
+	}
+}
+
+inline bool deliver(ServerConnection& connection, const std::string& message, bool bKnownLength)
+{
+	return deliver(connection, message.data(), message.size(), bKnownLength);
+}
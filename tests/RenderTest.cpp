@@ -0,0 +1,338 @@
+#include "Check.h"
+
+#include <Game/Rendering/Renderer.h>
+#include <Game/Rendering/RecordingDevice.h>
+#include <Game/Rendering/Text.h>
+#include <Game/Rendering/Box.h>
+#include <Game/Rendering/Line.h>
+#include <Game/Rendering/Image.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Every allocation of the test, see testQueueWithoutAllocations()
+static std::atomic<int> g_allocations(0);
+
+void *operator new(size_t size)
+{
+	g_allocations++;
+
+	if (void *p = std::malloc(size ? size : 1))
+		return p;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	std::free(p);
+}
+
+static int countEvents(const std::vector<OverlayEvent>& events, OverlayEvent event)
+{
+	int count = 0;
+	for (auto e : events)
+		count += e == event;
+
+	return count;
+}
+
+// The objects are shared by all Renderers, every test leaves none behind
+static void clearObjects(Renderer& renderer, RecordingDevice& device)
+{
+	renderer.destroyAll();
+	renderer.draw(&device);
+
+	CHECK(device.counts().resourcesAlive == 0);
+}
+
+// Draws a fixed scene and checks what reaches the device
+static void testScene()
+{
+	Renderer renderer;
+	RecordingDevice device(1024, 768);
+
+	std::vector<OverlayEvent> events;
+	renderer.setEventCallback([&](OverlayEvent event, int, int) { events.push_back(event); });
+
+	int text = renderer.add(std::make_shared<Text>(&renderer, "Arial", 12, false, false, 1, 1, 0xFFFFFFFF, "text", true, true));
+	int box = renderer.add(std::make_shared<Box>(&renderer, 1, 1, 10, 10, 0xFF00FF00, true));
+	renderer.add(std::make_shared<Line>(&renderer, 1, 1, 10, 10, 2, 0xFF00FF00, true));
+	renderer.add(std::make_shared<Image>(&renderer, "image.png", 1, 1, 0, 0, true));
+
+	CHECK(text >= 0 && box >= 0);
+
+	// Text: 4 shadows and the text; box: 1 strip of 2 triangles; line: 1; image: 1
+	renderer.draw(&device);
+	CHECK(device.counts().drawCalls == 8);
+	CHECK(device.counts().primitives == 2);
+	CHECK(device.counts().stateChanges == 4);
+	CHECK(device.counts().resourcesCreated == 6);
+	CHECK(device.counts().resourcesAlive == 6);
+	CHECK(renderer.screenWidth() == 1024 && renderer.screenHeight() == 768);
+	CHECK(countEvents(events, EventResolutionChanged) == 1);
+
+	// Resources are only created once
+	device.clear();
+	renderer.draw(&device);
+	CHECK(device.counts().drawCalls == 8);
+	CHECK(device.counts().resourcesCreated == 0);
+
+	// The border adds 4 strips
+	auto pBox = renderer.getAs<Box>(box);
+	renderer.queueUpdate(pBox, PropertyBorderShown, [](RenderBase *object, const Renderer::Update& update) {
+		static_cast<Box *>(object)->setBorderShown(true);
+		static_cast<Box *>(object)->setBorderWidth(update.values[0]);
+	}, 2);
+
+	device.clear();
+	renderer.draw(&device);
+	CHECK(device.counts().drawCalls == 12);
+	CHECK(device.counts().primitives == 10);
+
+	// Hidden objects aren't drawn
+	renderer.hideAll();
+	device.clear();
+	renderer.draw(&device);
+	CHECK(device.counts().drawCalls == 0);
+	CHECK(device.counts().stateChanges == 0);
+
+	renderer.showAll();
+	device.clear();
+	renderer.draw(&device);
+	CHECK(device.counts().drawCalls == 12);
+
+	// Everything is released once the objects are gone
+	CHECK(renderer.remove(text));
+	renderer.destroyAll();
+	device.clear();
+	renderer.draw(&device);
+	CHECK(device.counts().drawCalls == 0);
+	CHECK(device.counts().resourcesAlive == 0);
+	CHECK(!renderer.get(box));
+}
+
+// A resource which can't be loaded is reported once and retried every frame
+static void testLoadFailure()
+{
+	Renderer renderer;
+	RecordingDevice device;
+
+	std::vector<OverlayEvent> events;
+	renderer.setEventCallback([&](OverlayEvent event, int, int) { events.push_back(event); });
+
+	device.setFailResources(true);
+	renderer.add(std::make_shared<Image>(&renderer, "missing.png", 1, 1, 0, 0, true));
+
+	renderer.draw(&device);
+	renderer.draw(&device);
+	CHECK(device.counts().drawCalls == 0);
+	CHECK(countEvents(events, EventLoadFailed) == 1);
+
+	device.setFailResources(false);
+	device.clear();
+	renderer.draw(&device);
+	CHECK(device.counts().drawCalls == 1);
+	CHECK(device.counts().resourcesAlive == 2);
+
+	clearObjects(renderer, device);
+}
+
+// Resources which can't be restored after a device reset are retried like a failed load
+static void testResetFailure()
+{
+	Renderer renderer;
+	RecordingDevice device;
+
+	std::vector<OverlayEvent> events;
+	renderer.setEventCallback([&](OverlayEvent event, int, int) { events.push_back(event); });
+
+	renderer.add(std::make_shared<Text>(&renderer, "Arial", 12, false, false, 1, 1, 0xFFFFFFFF, "text", true, true));
+	renderer.add(std::make_shared<Box>(&renderer, 1, 1, 10, 10, 0xFF00FF00, true));
+	renderer.add(std::make_shared<Line>(&renderer, 1, 1, 10, 10, 2, 0xFF00FF00, true));
+	renderer.add(std::make_shared<Image>(&renderer, "image.png", 1, 1, 0, 0, true));
+
+	renderer.draw(&device);
+	CHECK(device.counts().drawCalls == 8);
+
+	// Only the image keeps its resources across a reset
+	renderer.reset(&device);
+	CHECK(countEvents(events, EventDeviceReset) == 1);
+	CHECK(device.counts().resets == 2);
+
+	device.setFailResources(true);
+	device.clear();
+	renderer.draw(&device);
+	renderer.draw(&device);
+	CHECK(device.counts().drawCalls == 2);
+	CHECK(device.counts().stateChanges == 0);
+	CHECK(countEvents(events, EventLoadFailed) == 3);
+
+	device.setFailResources(false);
+	device.clear();
+	renderer.draw(&device);
+	CHECK(device.counts().drawCalls == 8);
+	CHECK(device.counts().stateChanges == 4);
+	CHECK(device.counts().resourcesAlive == 6);
+
+	clearObjects(renderer, device);
+}
+
+// The id of a removed object doesn't reach the object which reuses its slot
+static void testStaleId()
+{
+	Renderer renderer;
+	RecordingDevice device;
+
+	int old = renderer.add(std::make_shared<Box>(&renderer, 1, 1, 10, 10, 0xFF00FF00, true));
+	CHECK(renderer.remove(old));
+
+	// The slot is freed once the frame has released the object
+	renderer.draw(&device);
+	CHECK(!renderer.get(old));
+
+	int reused = renderer.add(std::make_shared<Box>(&renderer, 2, 2, 10, 10, 0xFF00FF00, true));
+	CHECK(reused != old);
+	const int slotMask = SlotMap<int>::MaxSize - 1;
+	CHECK((reused & slotMask) == (old & slotMask));
+
+	CHECK(!renderer.getAs<Box>(old));
+	CHECK(!renderer.remove(old));
+	CHECK(renderer.getAs<Box>(reused));
+
+	CHECK(renderer.remove(reused));
+	clearObjects(renderer, device);
+}
+
+// A frame drawn while a batch is open shows none of its changes, the next one all of them
+static void testUpdateGroup()
+{
+	Renderer renderer;
+	RecordingDevice device;
+
+	typedef std::vector<unsigned int> Colors;
+
+	int kept = renderer.add(std::make_shared<Box>(&renderer, 1, 1, 10, 10, 0xFF000001, true));
+	int removed = renderer.add(std::make_shared<Box>(&renderer, 1, 1, 10, 10, 0xFF000002, true));
+
+	renderer.draw(&device);
+	CHECK(device.stripColors() == Colors({ 0xFF000001, 0xFF000002 }));
+
+	{
+		Renderer::UpdateGroup group(renderer);
+
+		auto pBox = renderer.getAs<Box>(kept);
+		renderer.queueUpdate(pBox, PropertyColor, [](RenderBase *object, const Renderer::Update& update) {
+			static_cast<Box *>(object)->setBoxColor((unsigned int) update.values[0]);
+		}, 0xFF000003);
+		CHECK(renderer.remove(removed));
+
+		device.clear();
+		renderer.draw(&device);
+		CHECK(device.stripColors() == Colors({ 0xFF000001, 0xFF000002 }));
+	}
+
+	device.clear();
+	renderer.draw(&device);
+	CHECK(device.stripColors() == Colors({ 0xFF000003 }));
+	CHECK(!renderer.get(removed));
+
+	clearObjects(renderer, device);
+}
+
+// Handlers add and remove objects while frames are drawn
+static void testConcurrentRemove()
+{
+	Renderer renderer;
+	RecordingDevice device;
+
+	std::atomic<bool> bDone(false);
+
+	std::thread handler([&]()
+	{
+		for (int i = 0; i < 2000; i++)
+		{
+			int id = renderer.add(std::make_shared<Box>(&renderer, i, i, 10, 10, 0xFF00FF00, true));
+			CHECK(id >= 0);
+
+			if (i % 100 == 99)
+				renderer.destroyAll();
+			else if (i % 2 == 0)
+				CHECK(renderer.remove(id));
+		}
+
+		bDone = true;
+	});
+
+	while (!bDone)
+		renderer.draw(&device);
+
+	handler.join();
+	clearObjects(renderer, device);
+}
+
+// Once the queue has warmed up, queueing an update reuses the commands and text buffers of the previous frames
+static void testQueueWithoutAllocations()
+{
+	Renderer renderer;
+	RecordingDevice device;
+
+	auto pText = renderer.getAs<Text>(renderer.add(std::make_shared<Text>(&renderer, "Arial", 12, false, false, 1, 1, 0xFFFFFFFF, "text", true, true)));
+	auto pBox = renderer.getAs<Box>(renderer.add(std::make_shared<Box>(&renderer, 1, 1, 10, 10, 0xFF000001, true)));
+
+	auto setText = [](RenderBase *object, const Renderer::Update& update) { static_cast<Text *>(object)->setText(update.text); };
+	auto setColor = [](RenderBase *object, const Renderer::Update& update) { static_cast<Box *>(object)->setBoxColor((unsigned int) update.values[0]); };
+
+	const std::string str(100, 'x');
+	int allocations = 0;
+
+	for (int frame = 0; frame < 20; frame++)
+	{
+		int before = g_allocations;
+
+		for (int i = 0; i < 16; i++)
+		{
+			renderer.queueUpdate(pText, PropertyX, setText, boost::string_ref(str));
+			renderer.queueUpdate(pBox, PropertyColor, setColor, 0xFF000000 | i);
+		}
+
+		// Only counted once the first frames have filled the queue
+		if (frame >= 10)
+			allocations += g_allocations - before;
+
+		renderer.draw(&device);
+	}
+
+	CHECK(allocations == 0);
+	CHECK(renderer.coalescedUpdates() >= 20 * 30);
+
+	device.clear();
+	renderer.draw(&device);
+	CHECK(device.stripColors() == std::vector<unsigned int>({ 0xFF00000F }));
+
+	pText.reset();
+	pBox.reset();
+	clearObjects(renderer, device);
+}
+
+int main()
+{
+	testScene();
+	testLoadFailure();
+	testResetFailure();
+	testStaleId();
+	testUpdateGroup();
+	testConcurrentRemove();
+	testQueueWithoutAllocations();
+
+	return CHECK_RESULT();
+}
@@ -0,0 +1,343 @@
+#include "Check.h"
+
+#include <Utils/RingBuffer.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// A formatted block, aligned like a file mapping
+struct Block
+{
+	explicit Block(uint32_t capacity) : memory(new uint64_t[(RingBuffer::blockSize(capacity) + 7) / 8])
+	{
+		RingBuffer::format(data(), capacity);
+	}
+
+	void *data()
+	{
+		return memory.get();
+	}
+
+	uint32_t& word(size_t offset)
+	{
+		return *reinterpret_cast<uint32_t *>(reinterpret_cast<char *>(data()) + offset);
+	}
+
+	std::unique_ptr<uint64_t[]> memory;
+};
+
+// Offsets of the header fields and of the records, see RingBuffer::Header
+enum { HeadOffset = 0, TailOffset = 4, DataOffset = 64 };
+
+static bool pop(RingBuffer& ring, std::string& record)
+{
+	const char *data = nullptr;
+	uint32_t size = 0;
+	if (!ring.peek(data, size))
+		return false;
+
+	record.assign(data, size);
+	ring.pop();
+	return true;
+}
+
+static void testRecords()
+{
+	Block block(256);
+	RingBuffer producer(block.data()), consumer(block.data());
+
+	CHECK(producer.capacity() == 256);
+	CHECK(producer.maxRecordSize() == 124);
+	CHECK(consumer.empty());
+
+	std::string record;
+	CHECK(!pop(consumer, record));
+
+	CHECK(producer.push("first", 5));
+	CHECK(producer.push("", 0));
+	CHECK(producer.push("third", 5));
+	CHECK(!consumer.empty());
+
+	CHECK(pop(consumer, record) && record == "first");
+	CHECK(pop(consumer, record) && record.empty());
+	CHECK(pop(consumer, record) && record == "third");
+	CHECK(!pop(consumer, record));
+	CHECK(consumer.empty());
+
+	// Too large for the ring at all
+	std::string large(producer.maxRecordSize() + 1, 'x');
+	CHECK(!producer.push(large.data(), (uint32_t) large.size()));
+
+	large.resize(producer.maxRecordSize());
+	CHECK(producer.push(large.data(), (uint32_t) large.size()));
+	CHECK(pop(consumer, record) && record == large);
+}
+
+// Records of every size wrap around many times and stay in order
+static void testWrapAround()
+{
+	Block block(256);
+	RingBuffer producer(block.data()), consumer(block.data());
+
+	std::string record;
+	for (int i = 0; i < 2000; i++)
+	{
+		std::string sent(i % 100, char('a' + i % 26));
+
+		CHECK(producer.push(sent.data(), (uint32_t) sent.size()));
+		CHECK(pop(consumer, record) && record == sent);
+	}
+}
+
+// A full ring refuses records until the consumer makes room
+static void testFull()
+{
+	Block block(256);
+	RingBuffer producer(block.data()), consumer(block.data());
+
+	int pushed = 0;
+	while (producer.push("0123456789", 10))
+		pushed++;
+
+	CHECK(pushed == 256 / 16);
+
+	std::string record;
+	CHECK(pop(consumer, record) && record == "0123456789");
+	CHECK(producer.push("0123456789", 10));
+	CHECK(!producer.push("0123456789", 10));
+}
+
+static void testWakeup()
+{
+	Block block(256);
+	RingBuffer producer(block.data()), consumer(block.data());
+
+	CHECK(!producer.wakeupNeeded());
+
+	CHECK(consumer.beginWait());
+	CHECK(producer.push("x", 1));
+	CHECK(producer.wakeupNeeded());
+	CHECK(!producer.wakeupNeeded());
+	consumer.endWait();
+
+	// Nothing to wait for while a record is queued
+	CHECK(!consumer.beginWait());
+	CHECK(!producer.wakeupNeeded());
+}
+
+// Lengths and positions written by the other side are checked, a malformed record drops the ring
+static void testMalformed()
+{
+	std::string record;
+
+	// Length larger than the ring
+	{
+		Block block(256);
+		RingBuffer producer(block.data()), consumer(block.data());
+
+		CHECK(producer.push("abcd", 4));
+		block.word(DataOffset) = 0x7FFFFFFF;
+
+		CHECK(!pop(consumer, record));
+		CHECK(consumer.empty());
+		CHECK(producer.push("next", 4));
+		CHECK(pop(consumer, record) && record == "next");
+	}
+
+	// Length beyond the bytes which have been pushed
+	{
+		Block block(256);
+		RingBuffer producer(block.data()), consumer(block.data());
+
+		CHECK(producer.push("abcd", 4));
+		block.word(DataOffset) = 100;
+
+		CHECK(!pop(consumer, record));
+		CHECK(consumer.empty());
+	}
+
+	// Head further ahead than the ring is large
+	{
+		Block block(256);
+		RingBuffer producer(block.data()), consumer(block.data());
+
+		CHECK(producer.push("abcd", 4));
+		block.word(HeadOffset) = 4096;
+
+		CHECK(!pop(consumer, record));
+		CHECK(consumer.empty());
+	}
+
+	// Wrap marker without a record behind it
+	{
+		Block block(256);
+		RingBuffer producer(block.data()), consumer(block.data());
+
+		CHECK(producer.push("abcd", 4));
+		block.word(DataOffset) = 0xFFFFFFFF;
+
+		CHECK(!pop(consumer, record));
+		CHECK(consumer.empty());
+	}
+
+	// Record which would cross the end of the block
+	{
+		Block block(256);
+		RingBuffer producer(block.data()), consumer(block.data());
+
+		std::string filler(100, 'f');
+		CHECK(producer.push(filler.data(), 100));
+		CHECK(producer.push(filler.data(), 100));
+		CHECK(pop(consumer, record) && pop(consumer, record));
+
+		CHECK(producer.push("abcd", 4));
+		block.word(DataOffset + 208) = 100;
+		block.word(HeadOffset) = 208 + 104;
+
+		CHECK(!pop(consumer, record));
+		CHECK(consumer.empty());
+	}
+}
+
+// One producer and one consumer thread, like the client and the server
+static void testThreads()
+{
+	Block block(4096);
+	RingBuffer producer(block.data()), consumer(block.data());
+
+	const int count = 200000;
+	std::atomic<int> failures(0);
+
+	std::thread consumerThread([&]()
+	{
+		int expected = 0;
+		while (expected < count)
+		{
+			const char *data = nullptr;
+			uint32_t size = 0;
+			if (!consumer.peek(data, size))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			int value = -1;
+			if (size != sizeof(value) + expected % 32)
+				failures++;
+
+			memcpy(&value, data, sizeof(value));
+			if (value != expected)
+				failures++;
+
+			consumer.pop();
+			expected++;
+		}
+	});
+
+	char buffer[64] = { 0 };
+	for (int i = 0; i < count; i++)
+	{
+		memcpy(buffer, &i, sizeof(i));
+		while (!producer.push(buffer, sizeof(i) + i % 32))
+			std::this_thread::yield();
+	}
+
+	consumerThread.join();
+	CHECK(failures == 0);
+	CHECK(consumer.empty());
+}
+
+// Auto-reset event, stands in for the event the channel signals
+struct Event
+{
+	Event() : bSignaled(false)
+	{
+	}
+
+	void signal()
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		bSignaled = true;
+		cv.notify_one();
+	}
+
+	// False if nobody signaled it in time
+	bool wait(std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		bool bWoken = cv.wait_for(lock, timeout, [this]() { return bSignaled; });
+		bSignaled = false;
+		return bWoken;
+	}
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool bSignaled;
+};
+
+// The consumer sleeps whenever the ring is empty and only the producer's signal wakes it up.
+// A wait which times out while a record is queued is a wakeup both sides have missed.
+static void testSleepingConsumer()
+{
+	Block block(4096);
+	RingBuffer producer(block.data()), consumer(block.data());
+	Event event;
+
+	const int count = 20000;
+	std::atomic<int> missedWakeups(0);
+
+	std::thread consumerThread([&]()
+	{
+		int received = 0;
+		while (received < count)
+		{
+			std::string record;
+			if (pop(consumer, record))
+			{
+				received++;
+				continue;
+			}
+
+			if (!consumer.beginWait())
+				continue;
+
+			if (!event.wait(std::chrono::milliseconds(1000)) && !consumer.empty())
+				missedWakeups++;
+
+			consumer.endWait();
+		}
+	});
+
+	for (int i = 0; i < count; i++)
+	{
+		while (!producer.push("record", 6))
+			std::this_thread::yield();
+
+		if (producer.wakeupNeeded())
+			event.signal();
+	}
+
+	consumerThread.join();
+	CHECK(missedWakeups == 0);
+	CHECK(consumer.empty());
+}
+
+int main()
+{
+	testRecords();
+	testWrapAround();
+	testFull();
+	testWakeup();
+	testMalformed();
+	testThreads();
+	testSleepingConsumer();
+
+	return CHECK_RESULT();
+}
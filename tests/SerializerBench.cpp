@@ -0,0 +1,71 @@
+#include <Utils/Serializer.h>
+#include <Shared/MessageSchema.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Encodes and decodes typical messages, prints the time per message and the encoded size.
+// Argument: number of iterations
+template<PipeMessages M, typename Encode>
+void measure(const char *name, int iterations, Encode encode)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	Serializer serializer;
+	typename MessageSchema<M>::Args args;
+	long long checksum = 0;
+
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < iterations; i++)
+	{
+		serializer.clear();
+		encode(serializer, i);
+	}
+	Clock::time_point encoded = Clock::now();
+
+	for (int i = 0; i < iterations; i++)
+	{
+		Serializer in(serializer.data(), serializer.numberOfBytesUsed());
+		SERIALIZATION_READ(in, PipeMessages, eMessage);
+		decodeMessage<M>(in, args);
+		checksum += (long long) eMessage;
+	}
+	Clock::time_point decoded = Clock::now();
+
+	double encodeNs = std::chrono::duration<double, std::nano>(encoded - start).count() / iterations;
+	double decodeNs = std::chrono::duration<double, std::nano>(decoded - encoded).count() / iterations;
+
+	std::printf("%-16s %3d bytes  encode %7.1f ns  decode %7.1f ns  (%lld)\n", name,
+		serializer.numberOfBytesUsed(), encodeNs, decodeNs, checksum);
+}
+
+int main(int argc, char *argv[])
+{
+	int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+	if (iterations <= 0)
+		return 1;
+
+	measure<PipeMessages::TextSetPos>("TextSetPos", iterations, [](Serializer& serializer, int i)
+	{
+		encodeMessage<PipeMessages::TextSetPos>(serializer, i & 0xFF, 640 + (i & 0x3F), 480);
+	});
+
+	measure<PipeMessages::BoxSetColor>("BoxSetColor", iterations, [](Serializer& serializer, int i)
+	{
+		encodeMessage<PipeMessages::BoxSetColor>(serializer, i & 0xFF, 0x80FF0000u | i);
+	});
+
+	measure<PipeMessages::TextSetString>("TextSetString", iterations, [](Serializer& serializer, int i)
+	{
+		encodeMessage<PipeMessages::TextSetString>(serializer, i & 0xFF, boost::string_ref("{FFFFFF}Health: {FF0000}100"));
+	});
+
+	measure<PipeMessages::TextCreate>("TextCreate", iterations, [](Serializer& serializer, int i)
+	{
+		encodeMessage<PipeMessages::TextCreate>(serializer, boost::string_ref("Arial"), 12, true, false, i & 0x3FF, 200,
+			0xFFFFFFFFu, boost::string_ref("Overlay text"), true, true);
+	});
+
+	return 0;
+}
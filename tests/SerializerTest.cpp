@@ -0,0 +1,423 @@
+#include "Check.h"
+
+#include <Utils/Serializer.h>
+#include <Utils/Utf8.h>
+#include <Shared/MessageSchema.h>
+
+#include <climits>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Argument values of the round trips, chosen by the argument's position so that every
+// message sees the varint boundaries and the extremes of its field types
+template<typename T> struct Sample;
+
+template<> struct Sample<int>
+{
+	static int get(size_t i)
+	{
+		static const int values[] = { INT_MIN, -65, -64, -1, 0, 1, 63, 64, 8191, 8192, INT_MAX };
+		return values[i % (sizeof(values) / sizeof(values[0]))];
+	}
+};
+
+template<> struct Sample<unsigned int>
+{
+	static unsigned int get(size_t i)
+	{
+		static const unsigned int values[] = { 0xFFFFFFFF, 0, 0x80000000, 0xFF00FF00 };
+		return values[i % (sizeof(values) / sizeof(values[0]))];
+	}
+};
+
+template<> struct Sample<bool>
+{
+	static bool get(size_t i)
+	{
+		return i % 2 == 0;
+	}
+};
+
+template<> struct Sample<boost::string_ref>
+{
+	static boost::string_ref get(size_t i)
+	{
+		static const char *values[] = { "Arial", "", "Gr\xC3\xBC\xC3\x9F" "e \xE2\x9C\x93", "{FF0000}red {00FF00}green" };
+		return values[i % (sizeof(values) / sizeof(values[0]))];
+	}
+};
+
+template<PipeMessages M, typename Args, size_t ...I>
+void encodeSample(Serializer& serializer, Args& args, IndexList<I...>)
+{
+	args = Args(Sample<typename std::tuple_element<I, Args>::type>::get(I)...);
+	encodeMessage<M>(serializer, std::get<I>(args)...);
+}
+
+// Strings of decoded arguments have to point into the request
+struct InBuffer
+{
+	const char *begin, *end;
+
+	template<typename T>
+	bool operator()(const T&) const
+	{
+		return true;
+	}
+
+	bool operator()(const boost::string_ref& str) const
+	{
+		return str.empty() || (str.data() >= begin && str.data() + str.size() <= end);
+	}
+};
+
+template<typename Args, size_t ...I>
+bool stringsInBuffer(const Args& args, const InBuffer& buffer, IndexList<I...>)
+{
+	bool result = true;
+	int expand[] = { 0, (result = result && buffer(std::get<I>(args)), 0)... };
+	(void) expand;
+	return result;
+}
+
+template<PipeMessages M>
+void roundTrip()
+{
+	typedef typename MessageSchema<M>::Args Args;
+	typedef typename MakeIndexList<std::tuple_size<Args>::value>::type Indices;
+
+	Args args;
+	Serializer serializer;
+	encodeSample<M>(serializer, args, Indices());
+
+	const char *data = serializer.data();
+	int size = serializer.numberOfBytesUsed();
+
+	if (MessageSize<M>::fixed)
+		CHECK(size <= (int) MessageSize<M>::max);
+
+	Serializer in(data, size);
+	SERIALIZATION_READ(in, PipeMessages, eMessage);
+	CHECK(eMessage == M);
+
+	Args decoded;
+	decodeMessage<M>(in, decoded);
+	CHECK(decoded == args);
+	CHECK(stringsInBuffer(decoded, InBuffer{ data, data + size }, Indices()));
+
+	// Every prefix decodes without reading past its end
+	for (int length = 0; length < size; length++)
+	{
+		std::vector<char> truncated(data, data + length);
+		Serializer partial(truncated.empty() ? nullptr : &truncated[0], length);
+
+		SERIALIZATION_READ(partial, PipeMessages, ePartial);
+		CHECK(length < 2 ? ePartial == PipeMessages(0) : ePartial == M);
+
+		Args partialArgs;
+		decodeMessage<M>(partial, partialArgs);
+		CHECK(stringsInBuffer(partialArgs, InBuffer{ truncated.data(), truncated.data() + length }, Indices()));
+	}
+}
+
+static void testMessages()
+{
+	roundTrip<PipeMessages::Ping>();
+
+	roundTrip<PipeMessages::TextCreate>();
+	roundTrip<PipeMessages::TextDestroy>();
+	roundTrip<PipeMessages::TextSetShadow>();
+	roundTrip<PipeMessages::TextSetShown>();
+	roundTrip<PipeMessages::TextSetColor>();
+	roundTrip<PipeMessages::TextSetPos>();
+	roundTrip<PipeMessages::TextSetString>();
+	roundTrip<PipeMessages::TextUpdate>();
+
+	roundTrip<PipeMessages::BoxCreate>();
+	roundTrip<PipeMessages::BoxDestroy>();
+	roundTrip<PipeMessages::BoxSetShown>();
+	roundTrip<PipeMessages::BoxSetBorder>();
+	roundTrip<PipeMessages::BoxSetBorderColor>();
+	roundTrip<PipeMessages::BoxSetColor>();
+	roundTrip<PipeMessages::BoxSetHeight>();
+	roundTrip<PipeMessages::BoxSetPos>();
+	roundTrip<PipeMessages::BoxSetWidth>();
+
+	roundTrip<PipeMessages::LineCreate>();
+	roundTrip<PipeMessages::LineDestroy>();
+	roundTrip<PipeMessages::LineSetShown>();
+	roundTrip<PipeMessages::LineSetColor>();
+	roundTrip<PipeMessages::LineSetWidth>();
+	roundTrip<PipeMessages::LineSetPos>();
+
+	roundTrip<PipeMessages::ImageCreate>();
+	roundTrip<PipeMessages::ImageDestroy>();
+	roundTrip<PipeMessages::ImageSetShown>();
+	roundTrip<PipeMessages::ImageSetAlign>();
+	roundTrip<PipeMessages::ImageSetPos>();
+	roundTrip<PipeMessages::ImageSetRotation>();
+
+	roundTrip<PipeMessages::DestroyAllVisual>();
+	roundTrip<PipeMessages::ShowAllVisual>();
+	roundTrip<PipeMessages::HideAllVisual>();
+
+	roundTrip<PipeMessages::GetFrameRate>();
+	roundTrip<PipeMessages::GetScreenSpecs>();
+
+	roundTrip<PipeMessages::SetCalculationRatio>();
+	roundTrip<PipeMessages::SetOverlayPriority>();
+
+	roundTrip<PipeMessages::Handshake>();
+
+	roundTrip<PipeMessages::StringIntern>();
+	roundTrip<PipeMessages::TextCreateInterned>();
+	roundTrip<PipeMessages::TextUpdateInterned>();
+
+	roundTrip<PipeMessages::OpenSharedMemory>();
+	roundTrip<PipeMessages::Sync>();
+	roundTrip<PipeMessages::Batch>();
+	roundTrip<PipeMessages::GetCoalescedUpdates>();
+	roundTrip<PipeMessages::BulkUpdate>();
+	roundTrip<PipeMessages::StringRelease>();
+}
+
+// Ids are part of the wire format, retired messages keep theirs reserved
+static void testMessageIds()
+{
+	CHECK(short(PipeMessages::TextCreate) == 2);
+	CHECK(short(PipeMessages::ReservedTextCreateUnicode) == 3);
+	CHECK(short(PipeMessages::TextDestroy) == 4);
+	CHECK(short(PipeMessages::ReservedTextSetStringUnicode) == 10);
+	CHECK(short(PipeMessages::ReservedTextUpdateUnicode) == 12);
+	CHECK(short(PipeMessages::BoxCreate) == 13);
+	CHECK(short(PipeMessages::LineCreate) == 22);
+	CHECK(short(PipeMessages::ImageCreate) == 28);
+	CHECK(short(PipeMessages::SetOverlayPriority) == 40);
+	CHECK(short(PipeMessages::Handshake) == 41);
+}
+
+static void testReplies()
+{
+	ServerInfo info = { PROTOCOL_VERSION, PROTOCOL_MAX_MESSAGE_SIZE, EncodingBinary, 0xFFFFFFFF };
+	ScreenSpecs specs(1920, -1080);
+
+	Serializer serializer;
+	serializer << info << specs;
+
+	Serializer in(serializer.data(), serializer.numberOfBytesUsed());
+
+	ServerInfo decodedInfo;
+	ScreenSpecs decodedSpecs;
+	in >> decodedInfo >> decodedSpecs;
+
+	CHECK(decodedInfo.protocolVersion == info.protocolVersion);
+	CHECK(decodedInfo.maxMessageSize == info.maxMessageSize);
+	CHECK(decodedInfo.encodings == info.encodings);
+	CHECK(decodedInfo.features == info.features);
+	CHECK(decodedSpecs == specs);
+}
+
+template<typename T>
+int encodedSize(T value)
+{
+	Serializer serializer;
+	serializer << value;
+
+	Serializer in(serializer.data(), serializer.numberOfBytesUsed());
+	T decoded = T();
+	in >> decoded;
+	CHECK(decoded == value);
+
+	return serializer.numberOfBytesUsed();
+}
+
+static void testIntegers()
+{
+	// Zigzag varints: 7 bits per byte, the sign takes the lowest bit
+	CHECK(encodedSize(0) == 1);
+	CHECK(encodedSize(-1) == 1);
+	CHECK(encodedSize(63) == 1);
+	CHECK(encodedSize(-64) == 1);
+	CHECK(encodedSize(64) == 2);
+	CHECK(encodedSize(-65) == 2);
+	CHECK(encodedSize(8191) == 2);
+	CHECK(encodedSize(8192) == 3);
+	CHECK(encodedSize(INT_MAX) == 5);
+	CHECK(encodedSize(INT_MIN) == 5);
+	CHECK(encodedSize((short) SHRT_MIN) == 3);
+	CHECK(encodedSize((long long) LLONG_MAX) == 10);
+	CHECK(encodedSize((long long) LLONG_MIN) == 10);
+
+	// Unsigned values and enums have a fixed width
+	CHECK(encodedSize(0u) == 4);
+	CHECK(encodedSize(0xFFFFFFFFu) == 4);
+	CHECK(encodedSize((unsigned short) 0xFFFF) == 2);
+	CHECK(encodedSize((unsigned long long) ULLONG_MAX) == 8);
+	CHECK(encodedSize(PipeMessages::BulkUpdate) == 2);
+	CHECK(encodedSize(true) == 1);
+
+	// A varint which doesn't end within 64 bits reads as 0
+	const char overlong[] = { '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\x01' };
+	Serializer in(overlong, sizeof(overlong));
+	long long value = 1;
+	in >> value;
+	CHECK(value == 0);
+
+	// A truncated varint as well
+	Serializer truncated(overlong, 3);
+	int truncatedValue = 1;
+	truncated >> truncatedValue;
+	CHECK(truncatedValue == 0);
+
+	// Reading past the end yields zeros
+	Serializer empty(nullptr, 0);
+	int i = 1;
+	unsigned int u = 1;
+	bool b = true;
+	empty >> i >> u >> b;
+	CHECK(i == 0 && u == 0 && !b);
+}
+
+static void testStrings()
+{
+	std::string str("nul\0inside", 10);
+	std::wstring wstr(L"\x00E4\x20AC\xFFFF");
+
+	Serializer serializer;
+	serializer << str << wstr << std::string() << std::wstring();
+
+	Serializer in(serializer.data(), serializer.numberOfBytesUsed());
+
+	std::string decoded("x"), decodedEmpty("x");
+	std::wstring wdecoded, wdecodedEmpty(L"x");
+	in >> decoded >> wdecoded >> decodedEmpty >> wdecodedEmpty;
+
+	CHECK(decoded == str);
+	CHECK(wdecoded == wstr);
+	CHECK(decodedEmpty.empty());
+	CHECK(wdecodedEmpty.empty());
+
+	// The length prefix is clamped to the bytes which are left: 1000000 followed by 3 bytes
+	const char prefix[] = { '\xC0', '\x84', '\x3D', 'a', 'b', 'c' };
+	Serializer oversizeIn(prefix, sizeof(prefix));
+
+	boost::string_ref ref;
+	oversizeIn >> ref;
+	CHECK(ref == "abc");
+
+	Serializer oversizeString(prefix, sizeof(prefix));
+	std::string value;
+	oversizeString >> value;
+	CHECK(value == "abc");
+
+	Serializer oversizeWide(prefix, sizeof(prefix));
+	std::wstring wvalue;
+	oversizeWide >> wvalue;
+	CHECK(wvalue == L"abc");
+
+	// A length larger than any buffer
+	const char huge[] = { '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\x7F', 'x' };
+	Serializer hugeIn(huge, sizeof(huge));
+	hugeIn >> ref;
+	CHECK(ref == "x");
+}
+
+// Decodes every code point of 'str' like the font does
+static std::vector<unsigned int> decodeUtf8(const std::string& str)
+{
+	std::vector<unsigned int> codePoints;
+
+	const char *it = str.data(), *end = str.data() + str.size();
+	while (it != end)
+		codePoints.push_back(utf8Decode(it, end));
+
+	return codePoints;
+}
+
+static void testUtf8()
+{
+	typedef std::vector<unsigned int> CodePoints;
+
+	CHECK(decodeUtf8("a\xC3\xA4\xE2\x82\xAC\xF0\x9F\x98\x80") == CodePoints({ 'a', 0xE4, 0x20AC, 0x1F600 }));
+	CHECK(decodeUtf8("\x7F\xC2\x80\xDF\xBF\xE0\xA0\x80\xEF\xBF\xBF\xF4\x8F\xBF\xBF") == CodePoints({ 0x7F, 0x80, 0x7FF, 0x800, 0xFFFF, 0x10FFFF }));
+
+	// A malformed sequence is replaced and only its first byte is skipped
+	CHECK(decodeUtf8("\x80" "a") == CodePoints({ 0xFFFD, 'a' }));
+	CHECK(decodeUtf8("\xC3" "a") == CodePoints({ 0xFFFD, 'a' }));
+	CHECK(decodeUtf8("\xE2\x82" "a") == CodePoints({ 0xFFFD, 0xFFFD, 'a' }));
+	CHECK(decodeUtf8("\xFF\xF8\xF5" "a") == CodePoints({ 0xFFFD, 0xFFFD, 0xFFFD, 'a' }));
+
+	// Truncated at the end of the string
+	CHECK(decodeUtf8("a\xC3") == CodePoints({ 'a', 0xFFFD }));
+	CHECK(decodeUtf8("\xE2\x82") == CodePoints({ 0xFFFD, 0xFFFD }));
+	CHECK(decodeUtf8("\xF0\x9F\x98") == CodePoints({ 0xFFFD, 0xFFFD, 0xFFFD }));
+
+	// Overlong encodings
+	CHECK(decodeUtf8("\xC0\xAF") == CodePoints({ 0xFFFD, 0xFFFD }));
+	CHECK(decodeUtf8("\xC1\xBF") == CodePoints({ 0xFFFD, 0xFFFD }));
+	CHECK(decodeUtf8("\xE0\x9F\xBF") == CodePoints({ 0xFFFD, 0xFFFD, 0xFFFD }));
+	CHECK(decodeUtf8("\xF0\x8F\xBF\xBF") == CodePoints({ 0xFFFD, 0xFFFD, 0xFFFD, 0xFFFD }));
+
+	// UTF-16 surrogates and values beyond U+10FFFF
+	CHECK(decodeUtf8("\xED\xA0\x80") == CodePoints({ 0xFFFD, 0xFFFD, 0xFFFD }));
+	CHECK(decodeUtf8("\xED\xBF\xBF") == CodePoints({ 0xFFFD, 0xFFFD, 0xFFFD }));
+	CHECK(decodeUtf8("\xED\x9F\xBF") == CodePoints({ 0xD7FF }));
+	CHECK(decodeUtf8("\xF4\x90\x80\x80") == CodePoints({ 0xFFFD, 0xFFFD, 0xFFFD, 0xFFFD }));
+}
+
+static void testBuffers()
+{
+	// Output written in place until the buffer is too small
+	char buffer[8];
+	Serializer serializer;
+	serializer.attachOutput(buffer, sizeof(buffer));
+	serializer << 1 << 2;
+	CHECK(serializer.data() == buffer);
+
+	serializer << std::string("longer than the buffer");
+	CHECK(serializer.data() != buffer);
+
+	Serializer in(serializer.data(), serializer.numberOfBytesUsed());
+	SERIALIZATION_READ(in, int, a);
+	SERIALIZATION_READ(in, int, b);
+	SERIALIZATION_READ(in, std::string, str);
+	CHECK(a == 1 && b == 2 && str == "longer than the buffer");
+
+	// clear() keeps the capacity, the Serializer can be reused for reading and writing
+	serializer.clear();
+	CHECK(serializer.numberOfBytesUsed() == 0);
+
+	serializer << 42;
+	SERIALIZATION_READ(serializer, int, reused);
+	CHECK(reused == 42);
+
+	// Bytes received into prepareBuffer() are read like written ones
+	Serializer received;
+	char *space = received.prepareBuffer(4);
+	memcpy(space, "\x02\x54\x00\x01", 4);
+	received.commitBuffer(4);
+
+	space = received.extendBuffer(1);
+	space[0] = '\x03';
+	received.commitBuffer(5);
+
+	SERIALIZATION_READ(received, int, first);
+	SERIALIZATION_READ(received, unsigned short, second);
+	SERIALIZATION_READ(received, bool, third);
+	SERIALIZATION_READ(received, int, fourth);
+	CHECK(first == 1 && second == 0x54 && third && fourth == -2);
+}
+
+int main()
+{
+	testMessages();
+	testMessageIds();
+	testReplies();
+	testIntegers();
+	testStrings();
+	testUtf8();
+	testBuffers();
+
+	return CHECK_RESULT();
+}
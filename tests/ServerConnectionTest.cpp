@@ -0,0 +1,127 @@
+#include "Check.h"
+#include "PipeReads.h"
+
+#include <Shared/MessageSchema.h>
+#include <Game/Dispatcher.h>
+
+#include <cstring>
+#include <string>
+
+// A request with a message id which isn't one-way, padded to 'size' bytes
+static std::string request(size_t size, char last)
+{
+	std::string message(size, 'x');
+	message[0] = message[1] = 0;
+	message.back() = last;
+
+	return message;
+}
+
+static std::string encode(Serializer& serializer)
+{
+	return std::string(serializer.data(), serializer.numberOfBytesUsed());
+}
+
+// Replies with the size of the request and its last byte
+static void echo(Serializer& serializerIn, Serializer& serializerOut)
+{
+	const char *data = serializerIn.data();
+	int size = serializerIn.numberOfBytesUsed();
+
+	serializerOut << size << (size > 0 ? data[size - 1] : char(0));
+}
+
+static void testSmallRequests()
+{
+	ServerConnection connection;
+
+	Serializer serializerIn;
+	encodeMessage<PipeMessages::Handshake>(serializerIn, PROTOCOL_VERSION);
+	CHECK(deliver(connection, encode(serializerIn), false));
+	CHECK(connection.handleRequest(&dispatchRequest));
+
+	Serializer reply(connection.reply(), connection.replySize());
+	ServerInfo info = ServerInfo();
+	reply >> info;
+	CHECK(info.protocolVersion == PROTOCOL_VERSION);
+	CHECK(info.maxMessageSize == PROTOCOL_MAX_MESSAGE_SIZE);
+
+	// One-way requests aren't answered
+	serializerIn.clear();
+	encodeOneWayMessage<PipeMessages::TextSetPos>(serializerIn, 1000, 1, 1);
+	CHECK(deliver(connection, encode(serializerIn), false));
+	CHECK(!connection.handleRequest(&dispatchRequest));
+}
+
+// Messages larger than the read buffer are assembled, with and without knowing their length
+static void testLargeRequests()
+{
+	for (int known = 0; known < 2; known++)
+	{
+		ServerConnection connection;
+
+		std::string message = request(3 * PROTOCOL_CHUNK_SIZE + 100, 'y');
+
+		CHECK(deliver(connection, message, known != 0));
+		CHECK(connection.handleRequest(&echo));
+
+		Serializer reply(connection.reply(), connection.replySize());
+		SERIALIZATION_READ(reply, int, size);
+		SERIALIZATION_READ(reply, char, last);
+		CHECK(size == (int) message.size());
+		CHECK(last == 'y');
+
+		// The next request starts in the fixed buffer again
+		CHECK(deliver(connection, request(3, 'b'), known != 0));
+		CHECK(connection.handleRequest(&echo));
+
+		Serializer small(connection.reply(), connection.replySize());
+		small >> size >> last;
+		CHECK(size == 3 && last == 'b');
+	}
+}
+
+// A message announced larger than the protocol allows is refused before it is stored
+static void testTooLarge()
+{
+	ServerConnection connection;
+
+	memset(connection.readBuffer(), 'x', connection.readSpace());
+	CHECK(!connection.continueRequest(connection.readSpace(), PROTOCOL_MAX_MESSAGE_SIZE));
+	CHECK(connection.readSpace() == PROTOCOL_CHUNK_SIZE);
+
+	// A partial request is dropped when the client leaves
+	CHECK(connection.continueRequest(connection.readSpace(), 0));
+	CHECK(connection.readSpace() > 0);
+	connection.reset();
+	CHECK(connection.readSpace() == PROTOCOL_CHUNK_SIZE);
+
+	CHECK(deliver(connection, request(3, 'c'), false));
+	CHECK(connection.handleRequest(&echo));
+	CHECK(connection.replySize() > 0);
+}
+
+// Replies larger than the reply buffer are kept until they are written
+static void testLargeReply()
+{
+	ServerConnection connection;
+	std::string large(2 * PROTOCOL_CHUNK_SIZE, 'r');
+
+	CHECK(deliver(connection, request(2, 0), false));
+	CHECK(connection.handleRequest([&](Serializer&, Serializer& serializerOut) { serializerOut << large; }));
+
+	Serializer reply(connection.reply(), connection.replySize());
+	std::string received;
+	reply >> received;
+	CHECK(received == large);
+}
+
+int main()
+{
+	testSmallRequests();
+	testLargeRequests();
+	testTooLarge();
+	testLargeReply();
+
+	return CHECK_RESULT();
+}
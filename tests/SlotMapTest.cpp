@@ -0,0 +1,105 @@
+#include "Check.h"
+
+#include <Utils/SlotMap.h>
+
+#include <string>
+
+typedef SlotMap<std::string> Strings;
+
+static void testHandles()
+{
+	Strings map;
+
+	Strings::Handle a = map.insert("a"), b = map.insert("b"), c = map.insert("c");
+	CHECK(a >= 0 && b >= 0 && c >= 0);
+	CHECK(map.size() == 3);
+	CHECK(*map.find(a) == "a" && *map.find(b) == "b" && *map.find(c) == "c");
+
+	// Erasing moves the last value into the gap, the other handles still find their values
+	CHECK(map.erase(a));
+	CHECK(map.size() == 2);
+	CHECK(*map.find(b) == "b" && *map.find(c) == "c");
+
+	CHECK(!map.find(-1));
+	CHECK(!map.find(Strings::MaxSize - 1));
+	CHECK(!map.erase(-1));
+}
+
+// A slot is reused by the next insert, the handle of its previous value doesn't find the new one
+static void testStaleHandles()
+{
+	Strings map;
+
+	Strings::Handle old = map.insert("old");
+	map.insert("other");
+	CHECK(map.erase(old));
+
+	Strings::Handle reused = map.insert("new");
+	CHECK(reused != old);
+	CHECK((reused & (Strings::MaxSize - 1)) == (old & (Strings::MaxSize - 1)));
+
+	CHECK(!map.find(old));
+	CHECK(!map.erase(old));
+	CHECK(*map.find(reused) == "new");
+	CHECK(map.size() == 2);
+
+	// Erasing twice fails the second time
+	CHECK(map.erase(reused));
+	CHECK(!map.erase(reused));
+	CHECK(map.size() == 1);
+}
+
+// The generation has GenerationBits bits, handles stay non-negative while it counts up and wraps
+static void testGenerationWrap()
+{
+	Strings map;
+
+	const int generations = 1 << Strings::GenerationBits;
+	Strings::Handle first = map.insert("0"), previous = first;
+	CHECK(map.erase(first));
+
+	for (int i = 1; i < generations; i++)
+	{
+		Strings::Handle handle = map.insert(std::to_string(i));
+		CHECK(handle >= 0);
+		CHECK(handle != previous);
+		CHECK(!map.find(previous));
+		CHECK(*map.find(handle) == std::to_string(i));
+		CHECK(map.erase(handle));
+
+		previous = handle;
+	}
+
+	// The highest generation still makes a non-negative handle, the next one starts over at 0
+	CHECK((unsigned int) previous >> Strings::IndexBits == (unsigned int) generations - 1);
+
+	Strings::Handle wrapped = map.insert("wrapped");
+	CHECK(wrapped == first);
+	CHECK(!map.find(previous));
+	CHECK(*map.find(wrapped) == "wrapped");
+}
+
+static void testEraseIf()
+{
+	Strings map;
+
+	Strings::Handle handles[6];
+	for (int i = 0; i < 6; i++)
+		handles[i] = map.insert(std::to_string(i));
+
+	map.erase_if([](Strings::Handle, const std::string& value) { return (value[0] - '0') % 2 == 0; });
+	CHECK(map.size() == 3);
+
+	for (int i = 0; i < 6; i++)
+		CHECK((map.find(handles[i]) != nullptr) == (i % 2 == 1));
+}
+
+int main()
+{
+	testHandles();
+	testStaleHandles();
+	testGenerationWrap();
+	testEraseIf();
+
+	return CHECK_RESULT();
+}
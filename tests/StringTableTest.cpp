@@ -0,0 +1,123 @@
+#include "Check.h"
+
+#include <Utils/StringTable.h>
+
+#include <string>
+
+static void testIntern()
+{
+	StringTable table(16);
+
+	int arial = table.intern("Arial"), tahoma = table.intern("Tahoma");
+	CHECK(arial > 0 && tahoma > 0 && arial != tahoma);
+	CHECK(table.size() == 2);
+
+	// The same string gets the same handle
+	CHECK(table.intern("Arial") == arial);
+	CHECK(table.size() == 2);
+
+	std::string str;
+	CHECK(table.lookup(arial, str) && str == "Arial");
+	CHECK(table.lookup(tahoma, str) && str == "Tahoma");
+
+	// An empty string is a string like every other
+	int empty = table.intern("");
+	CHECK(empty > 0 && table.lookup(empty, str) && str.empty());
+}
+
+// Handles which were never returned by intern() find nothing
+static void testUnknownHandles()
+{
+	StringTable table(16);
+	int handle = table.intern("Arial");
+
+	std::string str = "unchanged";
+	CHECK(!table.lookup(0, str));
+	CHECK(!table.lookup(-1, str));
+	CHECK(!table.lookup(handle + 1, str));
+	CHECK(!table.lookup(handle + (1 << 16), str));
+	CHECK(str == "unchanged");
+
+	CHECK(!table.release(0));
+	CHECK(!table.release(-1));
+	CHECK(!table.release(handle + 1));
+	CHECK(table.size() == 1);
+}
+
+static void testFull()
+{
+	StringTable table(3);
+
+	CHECK(table.intern("a") && table.intern("b") && table.intern("c"));
+	CHECK(table.intern("d") == 0);
+	CHECK(table.size() == 3);
+
+	// Strings which are already in the table are still found
+	CHECK(table.intern("a") != 0);
+
+	// A released string makes room for another one
+	int b = table.intern("b");
+	CHECK(table.release(b) && table.release(b));
+	CHECK(table.size() == 2);
+	CHECK(table.intern("d") != 0);
+}
+
+// The string stays until every intern() was released, its slot then gets another handle
+static void testRelease()
+{
+	StringTable table(16);
+
+	int first = table.intern("Arial");
+	CHECK(table.intern("Arial") == first);
+
+	std::string str;
+	CHECK(table.release(first));
+	CHECK(table.lookup(first, str) && str == "Arial");
+
+	CHECK(table.release(first));
+	CHECK(!table.lookup(first, str));
+	CHECK(!table.release(first));
+	CHECK(table.size() == 0);
+
+	int reused = table.intern("Tahoma");
+	CHECK(reused > 0 && reused != first);
+	CHECK((reused & 0xFFFF) == (first & 0xFFFF));
+	CHECK(!table.lookup(first, str));
+	CHECK(table.lookup(reused, str) && str == "Tahoma");
+
+	// Interning a released string again adds it anew
+	int again = table.intern("Arial");
+	CHECK(again > 0 && again != first);
+	CHECK(table.lookup(again, str) && str == "Arial");
+}
+
+// Handles stay positive while the generation of a slot counts up and wraps
+static void testGenerationWrap()
+{
+	StringTable table(1);
+
+	int first = table.intern("0");
+	bool bPositive = first > 0;
+	CHECK(table.release(first));
+
+	for (int i = 0; i < 0x10000; i++)
+	{
+		int handle = table.intern("x");
+		bPositive = bPositive && handle > 0;
+		table.release(handle);
+	}
+
+	CHECK(bPositive);
+	CHECK(table.size() == 0);
+}
+
+int main()
+{
+	testIntern();
+	testUnknownHandles();
+	testFull();
+	testRelease();
+	testGenerationWrap();
+
+	return CHECK_RESULT();
+}
@@ -0,0 +1,11 @@
+#include <Game/Game.h>
+#include <Game/Rendering/Renderer.h>
+
+// What the dispatcher needs from Game.cpp, without the hooks and the Windows-only transports
+Renderer g_pRenderer;
+std::atomic<int> g_oneWayFailures(0);
+
+int openSharedMemoryChannel(int)
+{
+	return 0;
+}
@@ -0,0 +1,127 @@
+#include "PipeReads.h"
+
+#include <Shared/MessageSchema.h>
+#include <Game/Game.h>
+#include <Game/Dispatcher.h>
+#include <Game/Rendering/Renderer.h>
+#include <Game/Rendering/RecordingDevice.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#define SCENE_OBJECTS	1000
+
+typedef std::chrono::steady_clock Clock;
+
+// Encodes one scene update into 'messages' and serves them like the pipe server does: read into a
+// ServerConnection in chunks, handed to the real dispatcher. The frame after every update isn't timed.
+// Prints the time per update and the throughput of the requests.
+template<typename Encode>
+void measure(const char *name, int updates, int setters, Encode encode)
+{
+	ServerConnection connection;
+	RecordingDevice device;
+	std::vector<std::string> messages;
+
+	double seconds = 0;
+	size_t bytes = 0;
+	for (int i = 0; i < updates; i++)
+	{
+		Clock::time_point start = Clock::now();
+
+		messages.clear();
+		encode(messages, i);
+
+		for (auto& message : messages)
+		{
+			deliver(connection, message, true);
+			connection.handleRequest(&dispatchRequest);
+			bytes += message.size();
+		}
+
+		seconds += std::chrono::duration<double>(Clock::now() - start).count();
+		g_pRenderer.draw(&device);
+	}
+
+	std::printf("%-20s %8d bytes  %9.1f us/update  %7.1f MB/s  %10.0f setters/s\n", name, int(bytes / updates),
+		seconds * 1e6 / updates, bytes / seconds / (1024 * 1024), setters * updates / seconds);
+}
+
+static std::string encoded(Serializer& serializer)
+{
+	return std::string(serializer.data(), serializer.numberOfBytesUsed());
+}
+
+// A scene update of SCENE_OBJECTS texts, sent per message (two-way and one-way) and as one streamed
+// Batch, and a long multi-line TextSetString.
+// Argument: number of scene updates per measurement
+int main(int argc, char *argv[])
+{
+	int updates = argc > 1 ? std::atoi(argv[1]) : 2000;
+	if (updates <= 0)
+		return 1;
+
+	std::vector<int> texts;
+	for (int i = 0; i < SCENE_OBJECTS; i++)
+	{
+		Serializer serializerIn, serializerOut;
+		encodeMessage<PipeMessages::TextCreate>(serializerIn, boost::string_ref("Arial"), 12, false, false, i % 640, i / 640,
+			0xFFFFFFFFu, boost::string_ref("text"), false, true);
+		dispatchRequest(serializerIn, serializerOut);
+
+		SERIALIZATION_READ(serializerOut, int, id);
+		texts.push_back(id);
+	}
+
+	measure("TextSetPos", updates, SCENE_OBJECTS, [&](std::vector<std::string>& messages, int i)
+	{
+		Serializer serializer;
+		for (int id : texts)
+		{
+			serializer.clear();
+			encodeMessage<PipeMessages::TextSetPos>(serializer, id, i % 640, 480);
+			messages.push_back(encoded(serializer));
+		}
+	});
+
+	measure("TextSetPos one-way", updates, SCENE_OBJECTS, [&](std::vector<std::string>& messages, int i)
+	{
+		Serializer serializer;
+		for (int id : texts)
+		{
+			serializer.clear();
+			encodeOneWayMessage<PipeMessages::TextSetPos>(serializer, id, i % 640, 480);
+			messages.push_back(encoded(serializer));
+		}
+	});
+
+	measure("TextSetPos batch", updates, SCENE_OBJECTS, [&](std::vector<std::string>& messages, int i)
+	{
+		Serializer commands, serializer;
+		for (int id : texts)
+			encodeMessage<PipeMessages::TextSetPos>(commands, id, i % 640, 480);
+
+		encodeMessage<PipeMessages::Batch>(serializer, (int) texts.size(), boost::string_ref(commands.data(), commands.numberOfBytesUsed()));
+		messages.push_back(encoded(serializer));
+	});
+
+	std::string lines;
+	while (lines.size() < 64 * 1024)
+		lines += "{FFFFFF}Player {FF0000}" + std::to_string(lines.size()) + "\n";
+
+	measure("TextSetString 64 KB", updates, 1, [&](std::vector<std::string>& messages, int)
+	{
+		Serializer serializer;
+		encodeMessage<PipeMessages::TextSetString>(serializer, texts[0], boost::string_ref(lines));
+		messages.push_back(encoded(serializer));
+	});
+
+	Serializer serializerIn, serializerOut;
+	encodeMessage<PipeMessages::DestroyAllVisual>(serializerIn);
+	dispatchRequest(serializerIn, serializerOut);
+
+	return 0;
+}